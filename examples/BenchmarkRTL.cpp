@@ -0,0 +1,259 @@
+#include "RTL.hpp"
+#include "MeanEstimator.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <map>
+
+using namespace std;
+
+class BenchConfig
+{
+public:
+    BenchConfig() : dataNumMax(1000000), iteration(100), minTime(0.5), minRun(3), tolerance(0.1) { }
+
+    int dataNumMax;
+    int iteration;
+    double minTime;
+    int minRun;
+    double tolerance;
+};
+
+class BenchResult
+{
+public:
+    BenchResult() : dataNum(0), inlierRate(0), run(0), hypothesisRate(0), pointRate(0), latencyP50(0), latencyP90(0), latencyP99(0) { }
+
+    string GetKey(void) const
+    {
+        ostringstream key;
+        key << estimator << ", " << algorithm << ", " << dataNum << ", " << inlierRate;
+        return key.str();
+    }
+
+    string estimator;
+    string algorithm;
+    int dataNum;
+    double inlierRate;
+    int run;
+    double hypothesisRate;
+    double pointRate;
+    double latencyP50;
+    double latencyP90;
+    double latencyP99;
+};
+
+// Get the given percentile of sorted latencies
+// - It is -1 (not reported) if there are too few runs to have any latency above it (e.g. less than 100 runs for P99).
+double GetPercentile(const vector<double>& latencies, int percent)
+{
+    if (latencies.empty() || latencies.size() * (100 - percent) < 100) return -1;
+    return latencies[(latencies.size() - 1) * percent / 100];
+}
+
+const char* ALGO_NAME[] = { "RANSAC", "MSAC", "LMedS", "MLESAC" };
+const int ALGO_NUM = sizeof(ALGO_NAME) / sizeof(const char*);
+
+// Measure the given algorithm with at most 'iteration' iterations
+// - Exact location models are disabled to measure sampling and evaluation of hypotheses.
+// - 'hypothesisRate' counts iterations actually performed (e.g. fewer after early termination).
+template <class Model, class Datum, class Data>
+BenchResult RunBench(RTL::RANSAC<Model, Datum, Data>* algorithm, const Data& data, int N, int M, const BenchConfig& config)
+{
+    algorithm->SetParamIteration(config.iteration);
+    algorithm->SetParamExactLocation(false);
+    vector<double> latencies;
+    double total = 0;
+    long long iteration = 0;
+    while (static_cast<int>(latencies.size()) < config.minRun || total < config.minTime)
+    {
+        Model model;
+        StopWatch watch;
+        watch.Start();
+        algorithm->FindBest(model, data, N, M);
+        double elapse = watch.GetElapse();
+        iteration += algorithm->GetIterationCount();
+        latencies.push_back(elapse);
+        total += elapse;
+    }
+    sort(latencies.begin(), latencies.end());
+
+    BenchResult result;
+    result.dataNum = N;
+    result.run = static_cast<int>(latencies.size());
+    result.hypothesisRate = iteration / total;
+    result.pointRate = result.hypothesisRate * N;
+    result.latencyP50 = GetPercentile(latencies, 50);
+    result.latencyP90 = GetPercentile(latencies, 90);
+    result.latencyP99 = GetPercentile(latencies, 99);
+    return result;
+}
+
+// Measure all algorithms with the given estimator and data
+template <class Model, class Datum, class Data>
+void RunBenchAll(vector<BenchResult>& results, const char* name, RTL::Estimator<Model, Datum, Data>* estimator, const Data& data, int N, int M, double inlierRate, double threshold, const BenchConfig& config)
+{
+    RTL::RANSAC<Model, Datum, Data> ransac(estimator);
+    RTL::MSAC<Model, Datum, Data> msac(estimator);
+    RTL::LMedS<Model, Datum, Data> lmeds(estimator);
+    RTL::MLESAC<Model, Datum, Data> mlesac(estimator);
+    RTL::RANSAC<Model, Datum, Data>* algorithms[] = { &ransac, &msac, &lmeds, &mlesac };
+    for (int algoIndex = 0; algoIndex < ALGO_NUM; algoIndex++)
+    {
+        algorithms[algoIndex]->SetParamThreshold(threshold);
+        BenchResult result = RunBench(algorithms[algoIndex], data, N, M, config);
+        result.estimator = name;
+        result.algorithm = ALGO_NAME[algoIndex];
+        result.inlierRate = inlierRate;
+        results.push_back(result);
+        cerr << result.GetKey() << ": " << result.hypothesisRate << " hypotheses/s, " << result.latencyP50 << " s (P50)" << endl;
+    }
+}
+
+// Format the given latency (or 'none' if it is not reported)
+string FormatLatency(double latency, const char* none)
+{
+    if (latency < 0) return none;
+    ostringstream text;
+    text << latency;
+    return text.str();
+}
+
+bool WriteResults(const char* output, const vector<BenchResult>& results)
+{
+    ofstream file(output);
+    if (!file.is_open()) return false;
+    const size_t length = strlen(output);
+    if (length > 5 && strcmp(output + length - 5, ".json") == 0)
+    {
+        file << "[" << endl;
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const BenchResult& r = results[i];
+            file << "  { \"estimator\": \"" << r.estimator << "\", \"algorithm\": \"" << r.algorithm << "\", \"dataNum\": " << r.dataNum << ", \"inlierRate\": " << r.inlierRate
+                 << ", \"run\": " << r.run << ", \"hypothesisRate\": " << r.hypothesisRate << ", \"pointRate\": " << r.pointRate
+                 << ", \"latencyP50\": " << FormatLatency(r.latencyP50, "null") << ", \"latencyP90\": " << FormatLatency(r.latencyP90, "null") << ", \"latencyP99\": " << FormatLatency(r.latencyP99, "null") << " }" << ((i + 1 < results.size()) ? "," : "") << endl;
+        }
+        file << "]" << endl;
+    }
+    else
+    {
+        // - Format: estimator, algorithm, dataNum, inlierRate, run, hypothesisRate, pointRate, latencyP50, latencyP90, latencyP99
+        // - A percentile with too few runs is left empty.
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const BenchResult& r = results[i];
+            file << r.GetKey() << ", " << r.run << ", " << r.hypothesisRate << ", " << r.pointRate << ", " << FormatLatency(r.latencyP50, "") << ", " << FormatLatency(r.latencyP90, "") << ", " << FormatLatency(r.latencyP99, "") << endl;
+        }
+    }
+    return true;
+}
+
+// Compare results with the baseline (in CSV) and return the number of regressions
+// - A regression is a case whose median latency is larger than its baseline more than 'tolerance'.
+int CompareResults(const char* baseline, const vector<BenchResult>& results, double tolerance)
+{
+    ifstream file(baseline);
+    if (!file.is_open())
+    {
+        cerr << "Cannot open the baseline, " << baseline << endl;
+        return -1;
+    }
+    map<string, double> baseLatency;
+    string line;
+    while (getline(file, line))
+    {
+        // The key has 4 fields, and the median latency is the 8th field.
+        vector<string> fields;
+        istringstream stream(line);
+        string field;
+        while (getline(stream, field, ','))
+        {
+            size_t begin = field.find_first_not_of(' ');
+            fields.push_back((begin == string::npos) ? string() : field.substr(begin));
+        }
+        if (fields.size() < 10) continue;
+        baseLatency[fields[0] + ", " + fields[1] + ", " + fields[2] + ", " + fields[3]] = atof(fields[7].c_str());
+    }
+
+    int regression = 0;
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        map<string, double>::const_iterator base = baseLatency.find(results[i].GetKey());
+        if (base == baseLatency.end() || base->second <= 0 || results[i].latencyP50 < 0) continue;
+        double ratio = results[i].latencyP50 / base->second;
+        if (ratio > 1 + tolerance)
+        {
+            cout << "REGRESSION: " << results[i].GetKey() << ": " << base->second << " s -> " << results[i].latencyP50 << " s (x" << ratio << ")" << endl;
+            regression++;
+        }
+        else if (ratio < 1 - tolerance)
+            cout << "IMPROVEMENT: " << results[i].GetKey() << ": " << base->second << " s -> " << results[i].latencyP50 << " s (x" << ratio << ")" << endl;
+    }
+    return regression;
+}
+
+// Usage: BenchmarkRTL [output (.csv or .json)] [--baseline baseline.csv] [--tolerance 0.1] [--max-n 1000000] [--iteration 100] [--min-run 3]
+int main(int argc, char* argv[])
+{
+    const char* output = "BenchmarkRTL.csv";
+    const char* baseline = NULL;
+    BenchConfig config;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) baseline = argv[++i];
+        else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) config.tolerance = atof(argv[++i]);
+        else if (strcmp(argv[i], "--max-n") == 0 && i + 1 < argc) config.dataNumMax = static_cast<int>(atof(argv[++i]));
+        else if (strcmp(argv[i], "--iteration") == 0 && i + 1 < argc) config.iteration = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--min-run") == 0 && i + 1 < argc) config.minRun = atoi(argv[++i]);
+        else output = argv[i];
+    }
+
+    // Measure all estimators, algorithms, the number of data, and inlier rates
+    const double INLIER_RATES[] = { 0.3, 0.6, 0.9 };
+    const Line LINE_TRUTH(0.6, 0.8, -300);
+    LineEstimator lineEstimator;
+    MeanEstimator meanEstimator;
+    vector<BenchResult> results;
+    for (int N = 100; N <= config.dataNumMax; N *= 10)
+    {
+        for (size_t r = 0; r < sizeof(INLIER_RATES) / sizeof(double); r++)
+        {
+            // Line fitting
+            {
+                vector<int> inliers;
+                LineObserver observer;
+                vector<Point> data = observer.GenerateData(LINE_TRUTH, N, inliers, 1, INLIER_RATES[r]);
+                RunBenchAll(results, "Line", &lineEstimator, data, N, 2, INLIER_RATES[r], 3, config);
+            }
+
+            // Mean calculation
+            {
+                std::mt19937 generator;
+                std::uniform_real_distribution<double> uniform(0, 1);
+                std::normal_distribution<double> normal(3, 0.1);
+                vector<double> data(N);
+                for (int i = 0; i < N; i++) data[i] = (uniform(generator) < INLIER_RATES[r]) ? normal(generator) : 100 * uniform(generator);
+                RunBenchAll(results, "Mean", &meanEstimator, data, N, 1, INLIER_RATES[r], 0.3, config);
+            }
+        }
+    }
+    if (!WriteResults(output, results))
+    {
+        cerr << "Cannot write the results, " << output << endl;
+        return -1;
+    }
+
+    // Compare with the baseline
+    if (baseline != NULL)
+    {
+        int regression = CompareResults(baseline, results, config.tolerance);
+        if (regression < 0) return -1;
+        cout << regression << " regression(s) against " << baseline << endl;
+        return (regression > 0) ? 1 : 0;
+    }
+    return 0;
+}
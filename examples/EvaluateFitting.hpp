@@ -0,0 +1,130 @@
+#ifndef __EVALUATE_FITTING__
+#define __EVALUATE_FITTING__
+
+#include "RTL.hpp"
+#include <iostream>
+#include <sstream>
+
+class ExpVar
+{
+public:
+    ExpVar() : dataNum(0), noiseLevel(0), inlierRate(0) { }
+    ExpVar(int num, double level, double rate) : dataNum(num), noiseLevel(level), inlierRate(rate) { }
+
+    int dataNum;
+    double noiseLevel;
+    double inlierRate;
+};
+
+// Run an experiment with synthetic data of 'Observer' for all configurations from 'expMin' to 'expMax'
+// - 'sampleSize' is the minimal number of data to compute a model (e.g. 2 for lines).
+template <class Observer, class Model, class Datum>
+bool RunRandomExp(const char* output, RTL::Estimator<Model, Datum, std::vector<Datum> >& estimator, Model truth, int sampleSize, const ExpVar& expMax, const ExpVar& expMin, const ExpVar& expStep, int expTrial, int expThread, bool verbose = true)
+{
+    typedef std::vector<Datum> Data;
+    typedef RTL::RANSAC<Model, Datum, Data>* AlgoPtr;
+
+    if (output == NULL) return false;
+
+    // Enumerate configurations
+    std::vector<ExpVar> configs;
+    ExpVar var;
+    for (var.dataNum = expMin.dataNum; var.dataNum <= expMax.dataNum; var.dataNum += expStep.dataNum)
+        for (var.noiseLevel = expMin.noiseLevel; var.noiseLevel <= expMax.noiseLevel; var.noiseLevel += expStep.noiseLevel)
+            for (var.inlierRate = expMin.inlierRate; var.inlierRate <= expMax.inlierRate; var.inlierRate += expStep.inlierRate)
+                configs.push_back(var);
+
+    // Run trials of all configurations in parallel
+    // - Each trial has its own algorithms because they keep their states during 'FindBest'.
+    // - 'compTime' is measured while trials share cores if they run on more than one thread.
+    // - A trial whose ground truth cannot be set fails, so it is not recorded and is run again by resuming.
+    Sweep sweep;
+    sweep.SetParamThreadNum(expThread);
+    bool success = sweep.Run(output, static_cast<int>(configs.size()), expTrial, [&](int config, int trial, unsigned int seed, std::string& result) -> bool
+    {
+        const ExpVar& var = configs[config];
+        RTL::RANSAC<Model, Datum, Data> ransac(&estimator);
+        RTL::LMedS<Model, Datum, Data> lmeds(&estimator);
+        RTL::MSAC<Model, Datum, Data> msac(&estimator);
+        RTL::MLESAC<Model, Datum, Data> mlesac(&estimator);
+        AlgoPtr algoPtr[] =
+        {
+            &ransac,
+            &lmeds,
+            &msac,
+            &mlesac,
+        };
+        const int algoNum = sizeof(algoPtr) / sizeof(AlgoPtr);
+
+        // Generate noisy data from the truth
+        std::vector<int> trueInliers;
+        Observer observer;
+        observer.SetSeed(seed);
+        Data data = observer.GenerateData(truth, var.dataNum, trueInliers, var.noiseLevel, var.inlierRate);
+        Evaluator<Model, Datum, Data> evaluator(&estimator);
+        if (data.empty() || !evaluator.SetGroundTruth(truth, data, var.dataNum, trueInliers)) return false;
+
+        std::ostringstream record;
+        for (int algoIndex = 0; algoIndex < algoNum; algoIndex++)
+        {
+            // Find the best model and its supporting inliers
+            Model model;
+            algoPtr[algoIndex]->SetParamSeed(seed);
+            StopWatch watch;
+            watch.Start();
+            double loss = algoPtr[algoIndex]->FindBest(model, data, data.size(), sampleSize);
+            double ctime = watch.GetElapse();
+            std::vector<int> inliers = algoPtr[algoIndex]->FindInliers(model, data, data.size());
+
+            // Evaluate the results
+            double nsse = evaluator.EvaluateModel(model);
+            Score score = evaluator.EvaluateInliers(inliers);
+
+            // Write the results
+            // - Format: dataNum, noiseLevel, inlierRate, expTrial, algoIndex, compTime, NSSE, TP, FP, FN
+            record << var.dataNum << ", " << var.noiseLevel << ", " << var.inlierRate << ", " << trial << ", " << algoIndex << ", " << ctime << ", " << nsse << ", " << score.tp << ", " << score.fp << ", " << score.fn << std::endl;
+        }
+        result = record.str();
+        return true;
+    });
+    if (verbose)
+    {
+        std::cout << output << ": " << sweep.GetTrialCount() << " trials (" << configs.size() * expTrial - sweep.GetTrialCount() - sweep.GetFailCount() << " resumed, " << sweep.GetFailCount() << " failed)";
+        if (expThread != 1) std::cout << " - Computing times are contended by parallel trials.";
+        std::cout << std::endl;
+    }
+    return success;
+}
+
+// Run three experiments which vary 'dataNum', 'noiseLevel', and 'inlierRate' from 'expDefault' respectively
+// - Results are written to 'name' + "(DataNum).csv", "(NoiseLevel).csv", and "(InlierRate).csv".
+template <class Observer, class Model, class Datum>
+bool RunRandomExps(const char* name, RTL::Estimator<Model, Datum, std::vector<Datum> >& estimator, Model truth, int sampleSize, const ExpVar& expDefault, const ExpVar& expMax, const ExpVar& expMin, const ExpVar& expStep, int expTrial, int expThread)
+{
+    bool success = true;
+
+    // Perform an experiment with varying 'dataNum'
+    ExpVar varMin, varMax;
+    varMin = expDefault;
+    varMin.dataNum = expMin.dataNum;
+    varMax = expDefault;
+    varMax.dataNum = expMax.dataNum;
+    success &= RunRandomExp<Observer>((std::string(name) + "(DataNum).csv").c_str(), estimator, truth, sampleSize, varMax, varMin, expStep, expTrial, expThread);
+
+    // Perform an experiment with varying 'noiseLevel'
+    varMin = expDefault;
+    varMin.noiseLevel = expMin.noiseLevel;
+    varMax = expDefault;
+    varMax.noiseLevel = expMax.noiseLevel;
+    success &= RunRandomExp<Observer>((std::string(name) + "(NoiseLevel).csv").c_str(), estimator, truth, sampleSize, varMax, varMin, expStep, expTrial, expThread);
+
+    // Perform an experiment with varying 'inlierRate'
+    varMin = expDefault;
+    varMin.inlierRate = expMin.inlierRate;
+    varMax = expDefault;
+    varMax.inlierRate = expMax.inlierRate;
+    success &= RunRandomExp<Observer>((std::string(name) + "(InlierRate).csv").c_str(), estimator, truth, sampleSize, varMax, varMin, expStep, expTrial, expThread);
+    return success;
+}
+
+#endif // End of '__EVALUATE_FITTING__'
@@ -0,0 +1,30 @@
+#include "EvaluateFitting.hpp"
+#include <cstring>
+
+using namespace std;
+
+// Usage: EvaluatePlaneFitting [--timing]
+// - '--timing' runs trials on a single thread, so their computing times are not contended by other trials.
+int main(int argc, char* argv[])
+{
+    // Configure experiments
+    const Plane  CONFIG_MODEL_TRUTH(0.36, 0.48, 0.8, -80);
+    const ExpVar CONFIG_EXP_DEFAULT(200, 0.6, 0.5);
+    const ExpVar CONFIG_EXP_MIN(100, 0.2, 0.1);
+    const ExpVar CONFIG_EXP_MAX(1000, 2.0, 0.9);
+    const ExpVar CONFIG_EXP_STEP(100, 0.2, 0.1);
+    const int    CONFIG_EXP_TRIAL = 1000;
+    int          CONFIG_EXP_THREAD = 0; // 0: all threads
+    const char*  CONFIG_EXP_NAME = "PlaneRandom";
+
+    for (int i = 1; i < argc; i++)
+        if (strcmp(argv[i], "--timing") == 0) CONFIG_EXP_THREAD = 1;
+
+    // Prepare an estimator (shared by all trials)
+    PlaneEstimator estimator;
+
+    // Perform experiments with varying 'dataNum', 'noiseLevel', and 'inlierRate'
+    RunRandomExps<PlaneObserver>(CONFIG_EXP_NAME, estimator, CONFIG_MODEL_TRUTH, 3, CONFIG_EXP_DEFAULT, CONFIG_EXP_MAX, CONFIG_EXP_MIN, CONFIG_EXP_STEP, CONFIG_EXP_TRIAL, CONFIG_EXP_THREAD);
+
+    return 0;
+}
@@ -1,24 +1,8 @@
-#include "RTL.hpp"
+#include "MeanEstimator.hpp"
 #include <iostream>
 
 using namespace std;
 
-// A mean calculator
-class MeanEstimator : public RTL::Estimator<double, double, vector<double> >
-{
-public:
-    // Calculate the mean of data at the sample indices
-    virtual double ComputeModel(const vector<double>& data, const set<int>& samples)
-    {
-        double mean = 0;
-        for (auto itr = samples.begin(); itr != samples.end(); itr++) mean += data[*itr];
-        return mean / samples.size();
-    }
-
-    // Calculate error between the mean and given datum
-    virtual double ComputeError(const double& mean, const double& datum) { return datum - mean; }
-};
-
 // The main function
 int main(void)
 {
@@ -38,5 +22,12 @@ int main(void)
     cout << "- Found Model: " << model << " (Loss: " << loss << ")" << endl;
     cout << "- The Number of Inliers: " << inliers.size() << " (N: " << data.size() << ")" << endl;
 
+    // Find the best model using RANSAC with static dispatch (and the sample size at compile time)
+    RTL::StaticRANSAC<MeanEstimator, 1> sransac(&estimator);
+    loss = sransac.FindBest(model, data, data.size());
+    inliers = sransac.FindInliers(model, data, data.size());
+    cout << "- Found Model (Static): " << model << " (Loss: " << loss << ")" << endl;
+    cout << "- The Number of Inliers (Static): " << inliers.size() << " (N: " << data.size() << ")" << endl;
+
     return 0;
 }
@@ -0,0 +1,39 @@
+#ifndef __MEAN_ESTIMATOR__
+#define __MEAN_ESTIMATOR__
+
+#include "RTL.hpp"
+
+// A mean calculator
+class MeanEstimator : public RTL::Estimator<double, double, std::vector<double> >
+{
+public:
+    // Calculate the mean of data at the sample indices
+    virtual double ComputeModel(const std::vector<double>& data, const std::set<int>& samples)
+    {
+        double mean = 0;
+        for (auto itr = samples.begin(); itr != samples.end(); itr++) mean += data[*itr];
+        return mean / samples.size();
+    }
+
+    // Calculate the mean of data at the sample indices (without building 'std::set')
+    virtual double ComputeModel(const std::vector<double>& data, const int* samples, int M)
+    {
+        double mean = 0;
+        for (int m = 0; m < M; m++) mean += data[samples[m]];
+        return mean / M;
+    }
+
+    // Calculate error between the mean and given datum
+    virtual double ComputeError(const double& mean, const double& datum) { return datum - mean; }
+
+    // Declare that the mean is a 1-D location (so RANSAC and MSAC find the best one exactly)
+    virtual bool GetLocation(const double& datum, double& location)
+    {
+        location = datum;
+        return true;
+    }
+
+    virtual double GetLocationModel(double location) { return location; }
+};
+
+#endif // End of '__MEAN_ESTIMATOR__'
@@ -1,19 +1,88 @@
 #ifndef __RTL_BASE__
 #define __RTL_BASE__
 
+#include <cstddef>
 #include <set>
 #include <vector>
 
 namespace RTL
 {
 
+// An incremental model estimator with sufficient statistics of the added data
+// - It is used for local optimization, which refits a model to its inliers whenever they change a little.
+template <class Model, class Datum>
+class Accumulator
+{
+public:
+    virtual ~Accumulator() { }
+
+    virtual void Clear(void) = 0;
+
+    virtual void Add(const Datum& datum) = 0;
+
+    virtual void Remove(const Datum& datum) = 0;
+
+    // Get the number of the added data
+    virtual int GetCount(void) = 0;
+
+    // Calculate a model from the added data
+    virtual Model ComputeModel(void) = 0;
+};
+
 template <class Model, class Datum, class Data>
 class Estimator
 {
 public:
+    typedef Model ModelType;
+
+    typedef Datum DatumType;
+
+    typedef Data DataType;
+
     virtual Model ComputeModel(const Data& data, const std::set<int>& samples) = 0;
 
+    // Calculate a model from 'M' distinct (but not sorted) sample indices
+    // - It can be overridden to avoid building 'std::set' for each hypothesis.
+    virtual Model ComputeModel(const Data& data, const int* samples, int M)
+    {
+        return ComputeModel(data, std::set<int>(samples, samples + M));
+    }
+
     virtual double ComputeError(const Model& model, const Datum& datum) = 0;
+
+    // Check whether 'M' samples can make a meaningful model (e.g. not coincident points)
+    // - A hypothesis from an invalid sample is redrawn before its evaluation, and it is not counted as an iteration.
+    virtual bool IsSampleValid(const Data& /*data*/, const int* /*samples*/, int /*M*/) { return true; }
+
+    // Check whether a model from samples is meaningful (e.g. finite), where an invalid one is also redrawn
+    virtual bool IsModelValid(const Model& /*model*/) { return true; }
+
+    // Calculate errors of data from 'begin' to 'end - 1' into 'errors'
+    // - It can be overridden with a batched (e.g. vectorized) implementation, which avoids a virtual call for each datum.
+    virtual void ComputeErrors(const Model& model, const Data& data, int begin, int end, double* errors)
+    {
+        for (int i = begin; i < end; i++)
+            errors[i - begin] = ComputeError(model, data[i]);
+    }
+
+    // Calculate errors of 'n' data at the given indices into 'errors'
+    // - It is used when only a subset of data is evaluated (e.g. the remaining data of 'RANSAC::FindMultiple').
+    virtual void ComputeIndexedErrors(const Model& model, const Data& data, const int* indices, int n, double* errors)
+    {
+        for (int i = 0; i < n; i++)
+            errors[i] = ComputeError(model, data[indices[i]]);
+    }
+
+    // Get the 1-D location of a datum if a model is a location whose error is 'location - model' (false: not supported)
+    // - Such models are found exactly by 'LocationSolver' instead of random sampling (e.g. a mean of scalars).
+    virtual bool GetLocation(const Datum& /*datum*/, double& /*location*/) { return false; }
+
+    // Make a model at the given 1-D location (used only if 'GetLocation' is supported)
+    virtual Model GetLocationModel(double /*location*/) { return Model(); }
+
+    // Create an accumulator which computes the same model incrementally (NULL: not supported)
+    // - The caller owns the returned accumulator.
+    virtual Accumulator<Model, Datum>* CreateAccumulator(void) { return NULL; }
 };
 
 template <class Model, class Datum, class Data>
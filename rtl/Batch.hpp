@@ -0,0 +1,170 @@
+#ifndef __RTL_BATCH__
+#define __RTL_BATCH__
+
+#include "RANSAC.hpp"
+#include <cassert>
+#include <functional>
+
+#ifdef _OPENMP
+#   include <omp.h>
+#endif
+
+namespace RTL
+{
+
+// A batch solver which finds the best models of many small and independent problems in parallel
+// - Each thread keeps its own algorithm (e.g. RANSAC or MSAC), which is created once and reused for all problems,
+//   so workspaces of the algorithm are not allocated again for each problem.
+// - Problems are distributed to threads dynamically, so threads which finish easy problems take the remaining ones.
+// - Each problem starts from 'paramSeed', so its result is the same as 'FindBest' of the algorithm with the same seed.
+template <class Model, class Datum, class Data>
+class BatchSolver
+{
+public:
+    typedef RANSAC<Model, Datum, Data> Algorithm;
+
+    // 'creator' creates a configured algorithm for each thread (and the solver deletes it)
+    // - e.g. 'BatchSolver<Line, Point, vector<Point> > batch([&]() { return new RTL::MSAC<Line, Point, vector<Point> >(&estimator); });'
+    BatchSolver(std::function<Algorithm*(void)> creator)
+    {
+        assert(creator);
+
+        toolCreator = creator;
+        SetParamThreadNum();
+        SetParamChunkSize();
+        SetParamSeed();
+    }
+
+    virtual ~BatchSolver() { ClearAlgorithms(); }
+
+    // Add a problem with 'N' data and the sample size 'M'
+    // - 'data' is not copied, so it should be kept until 'Solve' is finished.
+    int Add(const Data& data, int N, int M)
+    {
+        assert(N > 0 && M > 0);
+
+        Problem problem;
+        problem.data = &data;
+        problem.N = N;
+        problem.M = M;
+        problem.offset = dataProblems.empty() ? 0 : (dataProblems.back().offset + dataProblems.back().N);
+        dataProblems.push_back(problem);
+        return static_cast<int>(dataProblems.size()) - 1;
+    }
+
+    // Remove all problems
+    void Clear(void) { dataProblems.clear(); }
+
+    // Solve all problems and return the number of problems whose model is found
+    // - 'models' and 'losses' have a result of each problem ('HUGE_VAL' if its model is not found).
+    // - 'masks' has inlier flags of all problems in a row, where flags of the 'p'-th problem start at 'GetMaskOffset(p)'.
+    int Solve(std::vector<Model>& models, std::vector<double>& losses, std::vector<char>& masks)
+    {
+        const int problemNum = static_cast<int>(dataProblems.size());
+        models.resize(problemNum);
+        losses.assign(problemNum, HUGE_VAL);
+        masks.assign(GetMaskOffset(problemNum), 0);
+        if (problemNum <= 0) return 0;
+
+        // Prepare an algorithm for each thread
+        int threadNum = 1;
+#ifdef _OPENMP
+        threadNum = (paramThreadNum > 0) ? paramThreadNum : omp_get_max_threads();
+#endif
+        if (threadNum > problemNum) threadNum = problemNum;
+        while (static_cast<int>(toolAlgorithms.size()) < threadNum)
+        {
+            Algorithm* algorithm = toolCreator();
+            assert(algorithm != NULL);
+            algorithm->SetParamThreadNum(1);
+            algorithm->SetParamEvalThreadNum(1);
+            toolAlgorithms.push_back(algorithm);
+        }
+
+        // Solve problems in parallel
+        int found = 0;
+#pragma omp parallel for num_threads(threadNum) schedule(dynamic, paramChunkSize) reduction(+:found) if(threadNum > 1)
+        for (int p = 0; p < problemNum; p++)
+        {
+            int thread = 0;
+#ifdef _OPENMP
+            thread = omp_get_thread_num();
+#endif
+            Algorithm* algorithm = toolAlgorithms[thread];
+            const Problem& problem = dataProblems[p];
+            algorithm->SetParamSeed(paramSeed);
+            losses[p] = algorithm->FindBest(models[p], *problem.data, problem.N, problem.M);
+            if (losses[p] >= HUGE_VAL) continue;
+            std::vector<int> inliers = algorithm->FindInliers(models[p], *problem.data, problem.N);
+            for (size_t i = 0; i < inliers.size(); i++) masks[problem.offset + inliers[i]] = 1;
+            found++;
+        }
+        return found;
+    }
+
+    // Get the beginning index of inlier flags of the 'p'-th problem (or the total number of flags if 'p' is the number of problems)
+    int GetMaskOffset(int p)
+    {
+        if (p <= 0 || dataProblems.empty()) return 0;
+        if (p >= static_cast<int>(dataProblems.size())) return dataProblems.back().offset + dataProblems.back().N;
+        return dataProblems[p].offset;
+    }
+
+    // Get the number of added problems
+    int GetProblemNum(void) { return static_cast<int>(dataProblems.size()); }
+
+    // Set the number of threads which solve problems (0: all available threads)
+    void SetParamThreadNum(int thread = 0) { paramThreadNum = thread; }
+
+    int GetParamThreadNum(void) { return paramThreadNum; }
+
+    // Set the number of problems which are taken by a thread at once
+    void SetParamChunkSize(int size = 4) { paramChunkSize = size; }
+
+    int GetParamChunkSize(void) { return paramChunkSize; }
+
+    // Set the seed of random number generators, which is applied to each problem
+    void SetParamSeed(unsigned int seed = 5489) { paramSeed = seed; }
+
+    unsigned int GetParamSeed(void) { return paramSeed; }
+
+protected:
+    class Problem
+    {
+    public:
+        const Data* data;
+
+        int N;
+
+        int M;
+
+        int offset;
+    };
+
+    void ClearAlgorithms(void)
+    {
+        for (size_t t = 0; t < toolAlgorithms.size(); t++) delete toolAlgorithms[t];
+        toolAlgorithms.clear();
+    }
+
+    std::function<Algorithm*(void)> toolCreator;
+
+    std::vector<Algorithm*> toolAlgorithms;
+
+    int paramThreadNum;
+
+    int paramChunkSize;
+
+    unsigned int paramSeed;
+
+    std::vector<Problem> dataProblems;
+
+private:
+    BatchSolver(const BatchSolver&);
+
+    BatchSolver& operator=(const BatchSolver&);
+}; // End of 'BatchSolver'
+
+} // End of 'RTL'
+
+#endif // End of '__RTL_BATCH__'
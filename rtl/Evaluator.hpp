@@ -3,7 +3,16 @@
 
 #include "Base.hpp"
 #include <algorithm>
+#include <cassert>
 #include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#ifdef _OPENMP
+#   include <omp.h>
+#endif
 
 class Score
 {
@@ -30,18 +39,22 @@ public:
         trueSSE = -1;
     }
 
-    bool SetGroundTruth(const Model& model, const Data& data, int N, const std::vector<int> inliers)
+    // Set the true model and inliers of the given data
+    // - 'data' is not copied, so it should be kept until evaluation is finished.
+    bool SetGroundTruth(const Model& model, const Data& data, int N, const std::vector<int>& inliers)
     {
         trueModel = model;
         trueInliers = inliers;
-        noisyData.clear();
-        for (int i = 0; i < N; i++)
-            noisyData.push_back(data[i]);
+        noisyData = &data;
+        dataNum = N;
+        trueMask.assign(N, false);
+        for (size_t i = 0; i < trueInliers.size(); i++)
+            trueMask[trueInliers[i]] = true;
 
         trueSSE = 0;
         for (size_t i = 0; i < trueInliers.size(); i++)
         {
-            double error = toolEstimator->ComputeError(trueModel, noisyData[trueInliers[i]]);
+            double error = toolEstimator->ComputeError(trueModel, (*noisyData)[trueInliers[i]]);
             trueSSE += error * error;
         }
         return true;
@@ -54,7 +67,7 @@ public:
         double SSE = 0;
         for (size_t i = 0; i < trueInliers.size(); i++)
         {
-            double error = toolEstimator->ComputeError(model, noisyData[trueInliers[i]]);
+            double error = toolEstimator->ComputeError(model, (*noisyData)[trueInliers[i]]);
             SSE += error * error;
         }
         return (SSE / trueSSE);
@@ -67,12 +80,12 @@ public:
 
         for (size_t i = 0; i < inliers.size(); i++)
         {
-            bool found = (std::find(trueInliers.begin(), trueInliers.end(), inliers[i]) != trueInliers.end());
+            bool found = trueMask[inliers[i]];
             if (found) score.tp++;
             else       score.fp++;
         }
         int t = static_cast<int>(trueInliers.size());
-        int f = static_cast<int>(noisyData.size() - trueInliers.size());
+        int f = dataNum - t;
         score.fn = t - score.tp;
         score.tn = f - score.fp;
         return score;
@@ -87,9 +100,136 @@ protected:
 
     double trueSSE;
 
-    std::vector<Datum> noisyData;
+    std::vector<bool> trueMask;
+
+    const Data* noisyData;
+
+    int dataNum;
 }; // End of 'Evaluator'
 
+// A parameter sweep which runs trials of configurations in parallel and records their results in a file
+// - Each trial gets a deterministic seed from its configuration and trial indices, so its results do not depend on threads.
+// - Results of each trial are appended to the file as soon as it is finished, and the trial is also recorded in
+//   a progress file ('output' + ".progress"). Trials in the progress file are skipped, so an interrupted sweep can be resumed.
+// - A failed trial is recorded in neither file, so it is run again when the sweep is resumed.
+class Sweep
+{
+public:
+    Sweep()
+    {
+        SetParamThreadNum();
+        SetParamSeed();
+        dataTrialCount = 0;
+        dataFailCount = 0;
+    }
+
+    // Run 'func(config, trial, seed, result)' for 'trialNum' trials of 'configNum' configurations
+    // - 'func' writes lines of results to 'result' and returns false if the trial fails.
+    //   It is called by multiple threads at the same time.
+    // - It returns false if any trial fails or the files cannot be written.
+    template <class TrialFunction>
+    bool Run(const char* output, int configNum, int trialNum, TrialFunction func, bool resume = true)
+    {
+        if (output == NULL || configNum <= 0 || trialNum <= 0) return false;
+        const std::string progressName = std::string(output) + ".progress";
+
+        // Load finished trials and keep only their results
+        std::vector<char> finished(static_cast<size_t>(configNum) * trialNum, 0);
+        std::string kept, keptProgress;
+        if (resume)
+        {
+            std::ifstream progress(progressName.c_str(), std::ios::binary);
+            std::string line;
+            long long keptSize = 0;
+            while (std::getline(progress, line) && !progress.eof()) // The last line without a newline is incomplete.
+            {
+                int config = -1, trial = -1;
+                long long offset = 0;
+                if (sscanf(line.c_str(), "%d %d %lld", &config, &trial, &offset) != 3) continue;
+                if (config < 0 || config >= configNum || trial < 0 || trial >= trialNum) continue;
+                finished[static_cast<size_t>(config) * trialNum + trial] = 1;
+                keptProgress += line + "\n";
+                if (offset > keptSize) keptSize = offset;
+            }
+            std::ifstream previous(output, std::ios::binary);
+            kept.resize(static_cast<size_t>(keptSize));
+            if (keptSize > 0 && !previous.read(&kept[0], keptSize)) return false;
+        }
+
+        std::ofstream record(output, std::ios::binary | std::ios::trunc);
+        std::ofstream progress(progressName.c_str(), std::ios::binary | std::ios::trunc);
+        if (!record.is_open() || !progress.is_open()) return false;
+        record << kept;
+        progress << keptProgress;
+        record.flush();
+        progress.flush();
+
+        // Run unfinished trials
+        int threadNum = 1;
+#ifdef _OPENMP
+        threadNum = (paramThreadNum > 0) ? paramThreadNum : omp_get_max_threads();
+#endif
+        const int cellNum = configNum * trialNum;
+        int count = 0, fail = 0;
+#pragma omp parallel for num_threads(threadNum) schedule(dynamic, 1) if(threadNum > 1)
+        for (int cell = 0; cell < cellNum; cell++)
+        {
+            if (finished[cell]) continue;
+            const int config = cell / trialNum, trial = cell % trialNum;
+            std::string result;
+            const bool success = func(config, trial, GetTrialSeed(paramSeed, config, trial), result);
+#pragma omp critical(RTL_SWEEP)
+            if (!success) fail++;
+            else
+            {
+                record << result;
+                record.flush();
+                progress << config << " " << trial << " " << static_cast<long long>(record.tellp()) << "\n";
+                progress.flush();
+                count++;
+            }
+        }
+        dataTrialCount = count;
+        dataFailCount = fail;
+        return (fail == 0) && record.good() && progress.good();
+    }
+
+    // Get a seed of the given trial, which is mixed from the seed of the sweep by splitmix64
+    static unsigned int GetTrialSeed(unsigned int seed, int config, int trial)
+    {
+        uint64_t z = (static_cast<uint64_t>(seed) << 32) ^ (static_cast<uint64_t>(config) * 0x9e3779b97f4a7c15ULL) ^ static_cast<uint64_t>(trial);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        z = z ^ (z >> 31);
+        return static_cast<unsigned int>(z ^ (z >> 32));
+    }
+
+    // Set the number of threads which run trials (0: all available threads)
+    // - Trials share cores, so the computing time of each trial is measured more stably with a single thread.
+    void SetParamThreadNum(int thread = 0) { paramThreadNum = thread; }
+
+    int GetParamThreadNum(void) { return paramThreadNum; }
+
+    void SetParamSeed(unsigned int seed = 5489) { paramSeed = seed; }
+
+    unsigned int GetParamSeed(void) { return paramSeed; }
+
+    // Get the number of trials which are finished (not skipped nor failed) by the last 'Run'
+    int GetTrialCount(void) { return dataTrialCount; }
+
+    // Get the number of trials which failed in the last 'Run'
+    int GetFailCount(void) { return dataFailCount; }
+
+protected:
+    int paramThreadNum;
+
+    unsigned int paramSeed;
+
+    int dataTrialCount;
+
+    int dataFailCount;
+}; // End of 'Sweep'
+
 class StopWatch
 {
 public:
@@ -3,6 +3,9 @@
 
 #include "RANSAC.hpp"
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <cstdint>
 
 namespace RTL
 {
@@ -14,14 +17,179 @@ public:
     LMedS(Estimator<Model, Datum, Data>* estimator) : RANSAC<Model, Datum, Data>(estimator) { }
 
 protected:
+    using RANSAC<Model, Datum, Data>::toolGenerators;
+    using RANSAC<Model, Datum, Data>::BATCH_SIZE;
+
+    // The exact location solver does not support the median loss
+    virtual bool FindBestLocation(Model& /*best*/, double& /*bestloss*/, const Data& /*data*/, int /*N*/) { return false; }
+
+    // Calculate the median of absolute errors
+    // - A hypothesis is rejected as soon as 'N - N / 2' errors are not less than the bound of 'GetEvaluationBound',
+    //   because its median cannot be less than the bound.
+    // - Errors less than the bound are compacted in the workspace, and the median is selected among them.
     virtual double EvaluateModel(const Model& model, const Data& data, int N)
     {
-        std::vector<double> errors(N);
-        for (int i = 0; i < N; i++)
-            errors[i] = fabs(toolEstimator->ComputeError(model, data[i]));
-        std::nth_element(errors.begin(), errors.begin() + N / 2, errors.end());
-        return errors[N / 2];
+        const double bound = this->GetEvaluationBound();
+        const int k = N / 2, rejectNum = N - k;
+        const int threadNum = this->GetEvalThreadNum(N);
+        std::vector<double>& errors = dataErrors[this->GetThreadIndex()];
+        if (threadNum > 1)
+        {
+            std::atomic<int> exceeded(0);
+            this->RunBlocks(N, threadNum, [&](int /*t*/, int begin, int end)
+            {
+                for (int i = begin; i < end && exceeded.load(std::memory_order_relaxed) < rejectNum; i += BATCH_SIZE)
+                {
+                    const int size = this->GetBatchSize(i, end);
+                    this->ComputeErrors(model, data, i, i + size, &errors[i]);
+                    int count = 0;
+                    for (int j = i; j < i + size; j++)
+                    {
+                        errors[j] = fabs(errors[j]);
+                        count += (errors[j] >= bound);
+                    }
+                    exceeded += count;
+                }
+            });
+            if (exceeded.load() >= rejectNum) return HUGE_VAL;
+            return SelectParallel(errors, k, threadNum);
+        }
+
+        int n = 0, exceeded = 0;
+        double batch[BATCH_SIZE];
+        for (int i = 0; i < N; i += BATCH_SIZE)
+        {
+            const int size = this->GetBatchSize(i, N);
+            this->ComputeErrors(model, data, i, i + size, batch);
+            for (int j = 0; j < size; j++)
+            {
+                const double error = fabs(batch[j]);
+                errors[n] = error;
+                n += (error < bound);
+            }
+            exceeded = i + size - n;
+            if (exceeded >= rejectNum) return HUGE_VAL;
+        }
+        return SelectBucket(errors, n, k);
+    }
+
+    virtual void Initialize(const Data& data, int N)
+    {
+        RANSAC<Model, Datum, Data>::Initialize(data, N);
+        dataErrors.resize(toolGenerators.size());
+        for (size_t t = 0; t < dataErrors.size(); t++) dataErrors[t].resize(N);
+    }
+
+    // Select the 'k'-th smallest value among the first 'n' non-negative 'values' (which are reordered)
+    // - A histogram of values narrows candidates to a single bin, and only the bin is selected by 'std::nth_element'.
+    static double SelectBucket(std::vector<double>& values, int n, int k)
+    {
+        const int BIN_NUM = 1024, SMALL_NUM = 4096;
+        if (n > SMALL_NUM)
+        {
+            double maxValue = 0;
+            for (int i = 0; i < n; i++) maxValue = std::max(maxValue, values[i]);
+            if (maxValue <= 0) return 0;
+            if (maxValue == HUGE_VAL) return SelectDirect(values, n, k);
+
+            // Count values in each bin and find the bin which contains the 'k'-th value
+            const double scale = BIN_NUM / maxValue;
+            int histogram[BIN_NUM] = { 0 };
+            for (int i = 0; i < n; i++) histogram[GetBin(values[i], scale, BIN_NUM)]++;
+            int bin = 0, below = 0;
+            for (; below + histogram[bin] <= k; bin++) below += histogram[bin];
+
+            // Gather values in the bin in place
+            int m = 0;
+            for (int i = 0; i < n; i++)
+                if (GetBin(values[i], scale, BIN_NUM) == bin) values[m++] = values[i];
+            n = m;
+            k -= below;
+        }
+        return SelectDirect(values, n, k);
+    }
+
+    static int GetBin(double value, double scale, int binNum) { return std::min(static_cast<int>(value * scale), binNum - 1); }
+
+    static double SelectDirect(std::vector<double>& values, int n, int k)
+    {
+        std::nth_element(values.begin(), values.begin() + k, values.begin() + n);
+        return values[k];
+    }
+
+    // Select the 'k'-th smallest value among non-negative 'values' using radix selection
+    // - Non-negative doubles have the same order with their bit patterns, so each pass counts a digit of the bit
+    //   patterns in parallel and keeps only candidates in the bin which contains the 'k'-th value.
+    static double SelectParallel(std::vector<double>& values, int k, int threadNum)
+    {
+        const int BIT_NUM = 12, BIN_NUM = 1 << BIT_NUM, SMALL_NUM = 4096;
+        std::vector<double> candidates;
+        std::vector<int> histogram(threadNum * BIN_NUM);
+        std::vector<double>* source = &values;
+        int n = static_cast<int>(values.size());
+        for (int shift = 64 - BIT_NUM; n > SMALL_NUM; shift -= BIT_NUM)
+        {
+            if (shift < 0) shift = 0;
+
+            // Count the digit of each candidate
+            std::fill(histogram.begin(), histogram.end(), 0);
+#pragma omp parallel for num_threads(threadNum)
+            for (int t = 0; t < threadNum; t++)
+            {
+                int* count = &histogram[t * BIN_NUM];
+                const int end = RANSAC<Model, Datum, Data>::GetBlockBegin(n, t + 1, threadNum);
+                for (int i = RANSAC<Model, Datum, Data>::GetBlockBegin(n, t, threadNum); i < end; i++)
+                    count[(GetBits((*source)[i]) >> shift) & (BIN_NUM - 1)]++;
+            }
+
+            // Find the bin which contains the 'k'-th value
+            int bin = 0, below = 0, inside = 0;
+            for (bin = 0; bin < BIN_NUM; bin++)
+            {
+                inside = 0;
+                for (int t = 0; t < threadNum; t++) inside += histogram[t * BIN_NUM + bin];
+                if (below + inside > k) break;
+                below += inside;
+            }
+            k -= below;
+            if (shift == 0) return FindInBin(*source, n, bin, BIN_NUM); // All candidates in the bin are same.
+            if (inside == n) continue;
+
+            // Gather candidates in the bin (keeping the order of threads)
+            std::vector<double> gathered(inside);
+#pragma omp parallel for num_threads(threadNum)
+            for (int t = 0; t < threadNum; t++)
+            {
+                int offset = 0;
+                for (int s = 0; s < t; s++) offset += histogram[s * BIN_NUM + bin];
+                const int end = RANSAC<Model, Datum, Data>::GetBlockBegin(n, t + 1, threadNum);
+                for (int i = RANSAC<Model, Datum, Data>::GetBlockBegin(n, t, threadNum); i < end; i++)
+                    if (static_cast<int>((GetBits((*source)[i]) >> shift) & (BIN_NUM - 1)) == bin)
+                        gathered[offset++] = (*source)[i];
+            }
+            candidates.swap(gathered);
+            source = &candidates;
+            n = inside;
+        }
+        std::nth_element(source->begin(), source->begin() + k, source->begin() + n);
+        return (*source)[k];
+    }
+
+    static uint64_t GetBits(double value)
+    {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
     }
+
+    static double FindInBin(const std::vector<double>& values, int n, int bin, int binNum)
+    {
+        for (int i = 0; i < n; i++)
+            if (static_cast<int>(GetBits(values[i]) & (binNum - 1)) == bin) return values[i];
+        return values[0];
+    }
+
+    std::vector<std::vector<double> > dataErrors;
 };
 
 } // End of 'RTL'
@@ -3,59 +3,169 @@
 
 #include "Base.hpp"
 #include <cmath>
+#include <cfloat>
 #include <limits>
+#include <ostream>
 #include <random>
 
-class Point
+#if defined(__AVX2__) && defined(__FMA__)
+#   include <immintrin.h>
+#endif
+
+// A point whose coordinates are 'T' (e.g. 'float' halves memory traffic of large data)
+template <class T>
+class PointT
 {
 public:
-    Point() : x(0), y(0) { }
+    PointT() : x(0), y(0) { }
 
-    Point(double _x, double _y) : x(_x), y(_y) { }
+    PointT(T _x, T _y) : x(_x), y(_y) { }
 
-    friend std::ostream& operator<<(std::ostream& out, const Point& p) { return out << p.x << ", " << p.y; }
+    friend std::ostream& operator<<(std::ostream& out, const PointT& p) { return out << p.x << ", " << p.y; }
 
-    double x, y;
+    T x, y;
 };
 
-class Line
+template <class T>
+class LineT
 {
 public:
-    Line() : a(0), b(0), c(0) { }
+    LineT() : a(0), b(0), c(0) { }
 
-    Line(double _a, double _b, double _c) : a(_a), b(_b), c(_c) { }
+    LineT(T _a, T _b, T _c) : a(_a), b(_b), c(_c) { }
 
-    friend std::ostream& operator<<(std::ostream& out, const Line& l) { return out << l.a << ", " << l.b << ", " << l.c; }
+    friend std::ostream& operator<<(std::ostream& out, const LineT& l) { return out << l.a << ", " << l.b << ", " << l.c; }
 
-    double a, b, c;
+    T a, b, c;
 };
 
-class LineEstimator : virtual public RTL::Estimator<Line, Point, std::vector<Point> >
+typedef PointT<double> Point;
+
+typedef PointT<float> PointF;
+
+typedef LineT<double> Line;
+
+typedef LineT<float> LineF;
+
+// A structure-of-arrays container of points for vectorized evaluation
+template <class T>
+class PointArrayT
 {
 public:
-    virtual Line ComputeModel(const std::vector<Point>& data, const std::set<int>& samples)
+    typedef PointT<T> Point;
+
+    PointArrayT() { }
+
+    PointArrayT(const std::vector<Point>& points)
+    {
+        reserve(points.size());
+        for (size_t i = 0; i < points.size(); i++) push_back(points[i]);
+    }
+
+    Point operator[](size_t i) const { return Point(x[i], y[i]); }
+
+    void push_back(const Point& p)
+    {
+        x.push_back(p.x);
+        y.push_back(p.y);
+    }
+
+    void reserve(size_t n)
+    {
+        x.reserve(n);
+        y.reserve(n);
+    }
+
+    void clear(void)
+    {
+        x.clear();
+        y.clear();
+    }
+
+    size_t size(void) const { return x.size(); }
+
+    bool empty(void) const { return x.empty(); }
+
+    std::vector<T> x, y;
+};
+
+typedef PointArrayT<double> PointArray;
+
+typedef PointArrayT<float> PointArrayF;
+
+// A line estimator with 'Real' coordinates
+// - Errors are calculated in 'Real', but moments for fitting are always summed in 'double'.
+// - Only data are stored in 'Real'. Errors are passed to algorithms as 'double', whose thresholds and losses stay 'double':
+//   - Errors of a batch are kept in a small buffer in cache, so widening them does not add memory traffic.
+//   - Losses are summed over all data, where 'float' loses counts above 2^24 and precision of MSAC and MLESAC losses.
+template <class Data, class Real = double>
+class LineEstimatorT : virtual public RTL::Estimator<LineT<Real>, PointT<Real>, Data>
+{
+public:
+    typedef PointT<Real> Point;
+
+    typedef LineT<Real> Line;
+
+    virtual Line ComputeModel(const Data& data, const std::set<int>& samples)
+    {
+        return FitModel(data, samples.begin(), samples.end());
+    }
+
+    virtual Line ComputeModel(const Data& data, const int* samples, int M)
+    {
+        return FitModel(data, samples, samples + M);
+    }
+
+    virtual double ComputeError(const Line& line, const Point& point)
+    {
+        return line.a * point.x + line.b * point.y + line.c;
+    }
+
+    // Check whether samples are not all coincident (e.g. duplicated points of quantized data)
+    virtual bool IsSampleValid(const Data& data, const int* samples, int M)
+    {
+        const Point p = data[samples[0]];
+        for (int m = 1; m < M; m++)
+        {
+            const Point q = data[samples[m]];
+            if (q.x != p.x || q.y != p.y) return true;
+        }
+        return false;
+    }
+
+    // Check whether the line is finite and has its normal vector
+    virtual bool IsModelValid(const Line& line)
+    {
+        return std::isfinite(line.a) && std::isfinite(line.b) && std::isfinite(line.c) && (line.a != 0 || line.b != 0);
+    }
+
+    virtual void ComputeErrors(const Line& line, const Data& data, int begin, int end, double* errors)
+    {
+        for (int i = begin; i < end; i++)
+        {
+            const Point p = data[i];
+            errors[i - begin] = line.a * p.x + line.b * p.y + line.c;
+        }
+    }
+
+    virtual void ComputeIndexedErrors(const Line& line, const Data& data, const int* indices, int n, double* errors)
     {
-        double meanX = 0, meanY = 0, meanXX = 0, meanYY = 0, meanXY = 0;
-        for (auto itr = samples.begin(); itr != samples.end(); itr++)
+        for (int i = 0; i < n; i++)
         {
-            const Point& p = data[*itr];
-            meanX += p.x;
-            meanY += p.y;
-            meanXX += p.x * p.x;
-            meanYY += p.y * p.y;
-            meanXY += p.x * p.y;
+            const Point p = data[indices[i]];
+            errors[i] = line.a * p.x + line.b * p.y + line.c;
         }
-        size_t M = samples.size();
-        meanX /= M;
-        meanY /= M;
-        meanXX /= M;
-        meanYY /= M;
-        meanXY /= M;
-        double a = meanXX - meanX * meanX;
-        double b = meanXY - meanX * meanY;
-        double d = meanYY - meanY * meanY;
-
-        Line line;
+    }
+
+    // Fit a line to 'M' points from sums of their coordinates and their products
+    static Line FitLine(int M, double sumX, double sumY, double sumXX, double sumYY, double sumXY)
+    {
+        double meanX = sumX / M, meanY = sumY / M;
+        double a = sumXX / M - meanX * meanX;
+        double b = sumXY / M - meanX * meanY;
+        double d = sumYY / M - meanY * meanY;
+
+        double la, lb;
         if (fabs(b) > DBL_EPSILON)
         {
             // Calculate the first eigen vector of A = [a, b; b, d]
@@ -64,32 +174,146 @@ public:
             double lambda = T2 - sqrt(T2 * T2 - (a * d - b * b));
             double v1 = lambda - d, v2 = b;
             double norm = sqrt(v1 * v1 + v2 * v2);
-            line.a = v1 / norm;
-            line.b = v2 / norm;
+            la = v1 / norm;
+            lb = v2 / norm;
         }
         else
         {
-            line.a = 1;
-            line.b = 0;
+            la = 1;
+            lb = 0;
         }
-        line.c = -line.a * meanX - line.b * meanY;
-        return line;
+        return Line(static_cast<Real>(la), static_cast<Real>(lb), static_cast<Real>(-la * meanX - lb * meanY));
     }
 
-    virtual double ComputeError(const Line& line, const Point& point)
+    virtual RTL::Accumulator<Line, Point>* CreateAccumulator(void) { return new LineAccumulator(); }
+
+    // An incremental line estimator which keeps the sums of 'LineEstimatorT::FitModel'
+    class LineAccumulator : public RTL::Accumulator<Line, Point>
     {
-        return line.a * point.x + line.b * point.y + line.c;
+    public:
+        LineAccumulator() { Clear(); }
+
+        virtual void Clear(void)
+        {
+            count = 0;
+            sumX = sumY = sumXX = sumYY = sumXY = 0;
+        }
+
+        virtual void Add(const Point& p)
+        {
+            const double x = p.x, y = p.y;
+            count++;
+            sumX += x;
+            sumY += y;
+            sumXX += x * x;
+            sumYY += y * y;
+            sumXY += x * y;
+        }
+
+        virtual void Remove(const Point& p)
+        {
+            const double x = p.x, y = p.y;
+            count--;
+            sumX -= x;
+            sumY -= y;
+            sumXX -= x * x;
+            sumYY -= y * y;
+            sumXY -= x * y;
+        }
+
+        virtual int GetCount(void) { return count; }
+
+        virtual Line ComputeModel(void) { return FitLine(count, sumX, sumY, sumXX, sumYY, sumXY); }
+
+    protected:
+        int count;
+
+        double sumX, sumY, sumXX, sumYY, sumXY;
+    };
+
+protected:
+    // Fit a line to data at the given indices using their first and second moments
+    template <class Iterator>
+    Line FitModel(const Data& data, Iterator begin, Iterator end)
+    {
+        double sumX = 0, sumY = 0, sumXX = 0, sumYY = 0, sumXY = 0;
+        int M = 0;
+        for (Iterator itr = begin; itr != end; itr++, M++)
+        {
+            const Point p = data[*itr];
+            const double x = p.x, y = p.y;
+            sumX += x;
+            sumY += y;
+            sumXX += x * x;
+            sumYY += y * y;
+            sumXY += x * y;
+        }
+        return FitLine(M, sumX, sumY, sumXX, sumYY, sumXY);
+    }
+}; // End of 'LineEstimatorT'
+
+// Calculate errors of points in the structure-of-arrays (with AVX2 and FMA if they are enabled, e.g. '-mavx2 -mfma')
+template <>
+inline void LineEstimatorT<PointArray>::ComputeErrors(const LineT<double>& line, const PointArray& data, int begin, int end, double* errors)
+{
+    const double* x = data.x.data();
+    const double* y = data.y.data();
+    int i = begin;
+#if defined(__AVX2__) && defined(__FMA__)
+    const __m256d a = _mm256_set1_pd(line.a), b = _mm256_set1_pd(line.b), c = _mm256_set1_pd(line.c);
+    for (; i + 4 <= end; i += 4)
+    {
+        __m256d e = _mm256_fmadd_pd(b, _mm256_loadu_pd(y + i), c);
+        e = _mm256_fmadd_pd(a, _mm256_loadu_pd(x + i), e);
+        _mm256_storeu_pd(errors + i - begin, e);
     }
-}; // End of 'LineEstimator'
+#endif
+    for (; i < end; i++)
+        errors[i - begin] = line.a * x[i] + line.b * y[i] + line.c;
+}
 
-class LineObserver : virtual public RTL::Observer<Line, Point, std::vector<Point> >
+// Calculate errors of 'float' points in the structure-of-arrays (8 points at once with AVX2 and FMA)
+// - 'float' halves loads of data, and each error is widened to 'double' only when it is stored into the batch buffer.
+template <>
+inline void LineEstimatorT<PointArrayF, float>::ComputeErrors(const LineT<float>& line, const PointArrayF& data, int begin, int end, double* errors)
+{
+    const float* x = data.x.data();
+    const float* y = data.y.data();
+    int i = begin;
+#if defined(__AVX2__) && defined(__FMA__)
+    const __m256 a = _mm256_set1_ps(line.a), b = _mm256_set1_ps(line.b), c = _mm256_set1_ps(line.c);
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256 e = _mm256_fmadd_ps(b, _mm256_loadu_ps(y + i), c);
+        e = _mm256_fmadd_ps(a, _mm256_loadu_ps(x + i), e);
+        _mm256_storeu_pd(errors + i - begin, _mm256_cvtps_pd(_mm256_castps256_ps128(e)));
+        _mm256_storeu_pd(errors + i - begin + 4, _mm256_cvtps_pd(_mm256_extractf128_ps(e, 1)));
+    }
+#endif
+    for (; i < end; i++)
+        errors[i - begin] = line.a * x[i] + line.b * y[i] + line.c;
+}
+
+typedef LineEstimatorT<std::vector<Point> > LineEstimator;
+
+typedef LineEstimatorT<std::vector<PointF>, float> LineEstimatorF;
+
+template <class Real>
+class LineObserverT : virtual public RTL::Observer<LineT<Real>, PointT<Real>, std::vector<PointT<Real> > >
 {
 public:
-    LineObserver(Point _max = Point(640, 480), Point _min = Point(0, 0)) : RANGE_MAX(_max), RANGE_MIN(_min) { }
+    typedef PointT<Real> Point;
+
+    typedef LineT<Real> Line;
+
+    LineObserverT(Point _max = Point(640, 480), Point _min = Point(0, 0)) : RANGE_MAX(_max), RANGE_MIN(_min) { SetSeed(); }
+
+    // Set the seed of the random number generator, which is restarted for each 'GenerateData'
+    void SetSeed(unsigned int seed = std::mt19937::default_seed) { generatorSeed = seed; }
 
     virtual std::vector<Point> GenerateData(const Line& line, int N, std::vector<int>& inliers, double noise = 0, double ratio = 1)
     {
-        std::mt19937 generator;
+        std::mt19937 generator(generatorSeed);
         std::uniform_real_distribution<double> uniform(0, 1);
         std::normal_distribution<double> normal(0, 1);
 
@@ -146,6 +370,13 @@ public:
     const Point RANGE_MIN;
 
     const Point RANGE_MAX;
+
+protected:
+    unsigned int generatorSeed;
 };
 
+typedef LineObserverT<double> LineObserver;
+
+typedef LineObserverT<float> LineObserverF;
+
 #endif // End of '__RTL_LINE__'
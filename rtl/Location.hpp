@@ -0,0 +1,158 @@
+#ifndef __RTL_LOCATION__
+#define __RTL_LOCATION__
+
+#include "Base.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+#include <vector>
+
+namespace RTL
+{
+
+// An exact and deterministic solver of 1-D location models (e.g. a robust mean of scalars)
+// - The estimator should support 'Estimator::GetLocation' and 'Estimator::GetLocationModel'.
+// - Locations of data are sorted once, and the globally optimal model is found by a sweep in O(N log N).
+//   - RANSAC: The center of the narrowest window of width '2 * threshold' which has the most data
+//   - MSAC: The minimizer of the truncated quadratic loss, which is the mean of its inliers in one of O(N) intervals
+// - 'RANSAC' and 'MSAC' use it automatically for such estimators (see 'RANSAC::SetParamExactLocation').
+template <class Model, class Datum, class Data>
+class LocationSolver
+{
+public:
+    LocationSolver(Estimator<Model, Datum, Data>* estimator)
+    {
+        assert(estimator != NULL);
+
+        toolEstimator = estimator;
+        SetParamThreshold();
+        SetParamMSAC();
+    }
+
+    // Find the best model (or return 'HUGE_VAL' if the estimator does not support locations)
+    // - 'M' is not used because the solution does not depend on samples.
+    double FindBest(Model& best, const Data& data, int N, int M = 1)
+    {
+        assert(N > 0);
+
+        std::vector<double> values(N);
+        for (int i = 0; i < N; i++)
+            if (!toolEstimator->GetLocation(data[i], values[i])) return HUGE_VAL;
+        double location = 0;
+        double loss = paramMSAC ? FindMSAC(values, paramThreshold, location) : FindRANSAC(values, paramThreshold, location);
+        best = toolEstimator->GetLocationModel(location);
+        return loss;
+    }
+
+    std::vector<int> FindInliers(const Model& model, const Data& data, int N)
+    {
+        std::vector<int> inliers;
+        for (int i = 0; i < N; i++)
+            if (fabs(toolEstimator->ComputeError(model, data[i])) < paramThreshold) inliers.push_back(i);
+        return inliers;
+    }
+
+    // Find the location which has the most values within 'threshold' and return the number of the others
+    // - 'values' are sorted.
+    static double FindRANSAC(std::vector<double>& values, double threshold, double& location)
+    {
+        const int N = static_cast<int>(values.size());
+        if (N <= 0) return HUGE_VAL;
+        std::sort(values.begin(), values.end());
+
+        // Slide a window of width '2 * threshold' (the narrowest one among windows with the same count)
+        int bestBegin = 0, bestEnd = 0;
+        for (int begin = 0, end = 0; begin < N; begin++)
+        {
+            if (end < begin + 1) end = begin + 1;
+            while (end < N && values[end] - values[begin] <= 2 * threshold) end++;
+            const int count = end - begin, bestCount = bestEnd - bestBegin;
+            if (count > bestCount || (count == bestCount && values[end - 1] - values[begin] < values[bestEnd - 1] - values[bestBegin]))
+            {
+                bestBegin = begin;
+                bestEnd = end;
+            }
+        }
+        location = (values[bestBegin] + values[bestEnd - 1]) / 2;
+
+        double loss = 0;
+        for (int i = 0; i < N; i++) loss += (fabs(values[i] - location) > threshold);
+        return loss;
+    }
+
+    // Find the location which minimizes the truncated quadratic loss and return the loss
+    // - 'values' are sorted.
+    static double FindMSAC(std::vector<double>& values, double threshold, double& location)
+    {
+        const int N = static_cast<int>(values.size());
+        if (N <= 0) return HUGE_VAL;
+        std::sort(values.begin(), values.end());
+
+        // Sweep the location over intervals where inliers do not change
+        // - A value is an inlier from 'value - threshold' to 'value + threshold', and values are centered for precision.
+        const double center = values[N / 2], threshold2 = threshold * threshold;
+        double sum = 0, sum2 = 0, prev = -HUGE_VAL, bestLoss = HUGE_VAL, best = 0;
+        int inlierNum = 0;
+        for (int enter = 0, leave = 0; leave < N; )
+        {
+            const bool isEnter = (enter < N) && (values[enter] - threshold <= values[leave] + threshold);
+            const double next = (isEnter ? (values[enter] - threshold) : (values[leave] + threshold)) - center;
+            if (inlierNum > 0)
+            {
+                double m = sum / inlierNum;
+                if (m < prev) m = prev;
+                if (m > next) m = next;
+                const double loss = sum2 - 2 * m * sum + inlierNum * m * m + (N - inlierNum) * threshold2;
+                if (loss < bestLoss)
+                {
+                    bestLoss = loss;
+                    best = m;
+                }
+            }
+            if (isEnter)
+            {
+                const double u = values[enter++] - center;
+                sum += u;
+                sum2 += u * u;
+                inlierNum++;
+            }
+            else
+            {
+                const double u = values[leave++] - center;
+                sum -= u;
+                sum2 -= u * u;
+                inlierNum--;
+            }
+            prev = next;
+        }
+        location = best + center;
+
+        double loss = 0;
+        for (int i = 0; i < N; i++)
+        {
+            const double error = values[i] - location;
+            loss += std::min(error * error, threshold2);
+        }
+        return loss;
+    }
+
+    void SetParamThreshold(double threshold = 1) { paramThreshold = threshold; }
+
+    double GetParamThreshold(void) { return paramThreshold; }
+
+    // Set whether the loss is MSAC (true) or RANSAC (false)
+    void SetParamMSAC(bool use = false) { paramMSAC = use; }
+
+    bool GetParamMSAC(void) { return paramMSAC; }
+
+protected:
+    Estimator<Model, Datum, Data>* toolEstimator;
+
+    double paramThreshold;
+
+    bool paramMSAC;
+}; // End of 'LocationSolver'
+
+} // End of 'RTL'
+
+#endif // End of '__RTL_LOCATION__'
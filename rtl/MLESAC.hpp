@@ -2,6 +2,11 @@
 #define __RTL_MLESAC__
 
 #include "MSAC.hpp"
+#include <algorithm>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#   include <immintrin.h>
+#endif
 
 #ifndef M_PI
 #   define M_PI                         3.14159265358979323846
@@ -16,8 +21,8 @@ class MLESAC : virtual public RANSAC<Model, Datum, Data>
 public:
     MLESAC(Estimator<Model, Datum, Data>* estimator) : RANSAC<Model, Datum, Data>(estimator)
     {
-        dataError2 = NULL;
         SetParamIterationEM();
+        SetParamToleranceEM();
         SetParamSigmaScale();
     }
 
@@ -25,75 +30,148 @@ public:
 
     int GetParamIterationEM(void) { return paramIterationEM; }
 
+    // Set the tolerance of the inlier ratio, whose smaller change stops EM before 'paramIterationEM'
+    void SetParamToleranceEM(double tolerance = 1e-4) { paramToleranceEM = tolerance; }
+
+    double GetParamToleranceEM(void) { return paramToleranceEM; }
+
     void SetParamSigmaScale(double scale = 1.96) { paramSigmaScale = scale; }
 
     double GetParamSigmaScale(void) { return paramSigmaScale; }
 
 protected:
+    using RANSAC<Model, Datum, Data>::toolGenerators;
+    using RANSAC<Model, Datum, Data>::paramThreshold;
+
+    // The exact location solver does not support the likelihood loss
+    virtual bool FindBestLocation(Model& /*best*/, double& /*bestloss*/, const Data& /*data*/, int /*N*/) { return false; }
+
     virtual void Initialize(const Data& data, int N)
     {
-        RANSAC::Initialize(data, N);
-        dataError2 = new double[N];
-        assert(dataError2 != NULL);
+        RANSAC<Model, Datum, Data>::Initialize(data, N);
+        dataGaussian.resize(toolGenerators.size());
+        for (size_t t = 0; t < dataGaussian.size(); t++)
+            dataGaussian[t].resize(N);
         double sigma = paramThreshold / paramSigmaScale;
         dataSigma2 = sigma * sigma;
     }
 
+    // Calculate the negative log-likelihood of the given model
+    // - The Gaussian density of each datum does not depend on the inlier ratio, so it is calculated only once
+    //   (while calculating errors) and reused by all EM iterations.
+    // - The partial negative log-likelihood is bounded below by the largest density of a datum,
+    //   so evaluation is stopped when even the lower bound of the total exceeds 'GetEvaluationBound'.
     virtual double EvaluateModel(const Model& model, const Data& data, int N)
     {
-        // Calculate squared errors
-        double minError = HUGE_VAL, maxError = -HUGE_VAL;
-        for (int i = 0; i < N; i++)
+        const double bound = this->GetEvaluationBound();
+        double* gaussian = &dataGaussian[this->GetThreadIndex()][0];
+
+        // Calculate errors and their Gaussian densities (without the normalization)
+        const int threadNum = this->GetEvalThreadNum(N);
+        std::vector<double> minErrors(threadNum, HUGE_VAL), maxErrors(threadNum, -HUGE_VAL);
+        this->RunBlocks(N, threadNum, [&](int t, int begin, int end)
         {
-            double error = toolEstimator->ComputeError(model, data[i]);
-            if (error < minError) minError = error;
-            if (error > maxError) maxError = error;
-            dataError2[i] = error * error;
-        }
+            this->ComputeErrors(model, data, begin, end, gaussian + begin);
+            for (int i = begin; i < end; i++)
+            {
+                double error = gaussian[i];
+                if (error < minErrors[t]) minErrors[t] = error;
+                if (error > maxErrors[t]) maxErrors[t] = error;
+            }
+            ComputeGaussian(gaussian + begin, end - begin, -0.5 / dataSigma2);
+        });
+        const double nu = *std::max_element(maxErrors.begin(), maxErrors.end()) - *std::min_element(minErrors.begin(), minErrors.end());
+        const double normalizer = 1 / sqrt(2 * M_PI * dataSigma2);
 
         // Estimate the inlier ratio using EM
-        const double nu = maxError - minError;
         double gamma = 0.5;
         for (int iter = 0; iter < paramIterationEM; iter++)
         {
-            double sumPosteriorProb = 0;
             const double probOutlier = (1 - gamma) / nu;
-            const double probInlierCoeff = gamma / sqrt(2 * M_PI * dataSigma2);
-            for (int i = 0; i < N; i++)
+            const double probInlierCoeff = gamma * normalizer;
+            double sumPosteriorProb = this->SumBlocks(N, threadNum, [&](int begin, int end)
             {
-                double probInlier = probInlierCoeff * exp(-0.5 * dataError2[i] / dataSigma2);
-                sumPosteriorProb += probInlier / (probInlier + probOutlier);
-            }
+                double sum = 0;
+                for (int i = begin; i < end; i++)
+                {
+                    double probInlier = probInlierCoeff * gaussian[i];
+                    sum += probInlier / (probInlier + probOutlier);
+                }
+                return sum;
+            });
+            double gammaPrev = gamma;
             gamma = sumPosteriorProb / N;
+            if (fabs(gamma - gammaPrev) < paramToleranceEM) break;
         }
 
         // Evaluate the model
-        double sumLogLikelihood = 0;
         const double probOutlier = (1 - gamma) / nu;
-        const double probInlierCoeff = gamma / sqrt(2 * M_PI * dataSigma2);
-        for (int i = 0; i < N; i++)
+        const double probInlierCoeff = gamma * normalizer;
+        if (threadNum <= 1)
         {
-            double probInlier = probInlierCoeff * exp(-0.5 * dataError2[i] / dataSigma2);
-            sumLogLikelihood = sumLogLikelihood - log(probInlier + probOutlier);
+            const double lossMin = -log(probInlierCoeff + probOutlier);
+            double sumLogLikelihood = 0;
+            for (int i = 0; i < N; i++)
+            {
+                sumLogLikelihood -= log(probInlierCoeff * gaussian[i] + probOutlier);
+                if ((i & 255) == 255 && sumLogLikelihood + (N - i - 1) * lossMin > bound) return HUGE_VAL; // A partial loss is enough to reject
+            }
+            return sumLogLikelihood;
         }
-        return sumLogLikelihood;
+        return this->SumBlocks(N, threadNum, [&](int begin, int end)
+        {
+            double sum = 0;
+            for (int i = begin; i < end; i++)
+                sum -= log(probInlierCoeff * gaussian[i] + probOutlier);
+            return sum;
+        });
     }
 
-    virtual void Terminate(const Data& data, int N, const Model& bestModel)
+    // Replace each error 'e' in 'values' with 'exp(scale * e * e)' (with AVX2 and FMA if they are enabled)
+    static void ComputeGaussian(double* values, int n, double scale)
     {
-        if (dataError2 != NULL)
+        int i = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+        // exp(x) = 2^k * exp(r), where k = round(x / log(2)) and |r| <= log(2) / 2 (with Taylor series up to r^11)
+        // - 'x' less than -708 gives zero as 'exp' underflows, which also avoids slow arithmetic of subnormal numbers.
+        const __m256d s = _mm256_set1_pd(scale), xMin = _mm256_set1_pd(-708);
+        const __m256d log2e = _mm256_set1_pd(1.4426950408889634), ln2Hi = _mm256_set1_pd(6.93145751953125e-1), ln2Lo = _mm256_set1_pd(1.42860682030941723212e-6);
+        for (; i + 4 <= n; i += 4)
         {
-            delete [] dataError2;
-            dataError2 = NULL;
+            __m256d e = _mm256_loadu_pd(values + i);
+            __m256d x = _mm256_mul_pd(_mm256_mul_pd(s, e), e);
+            __m256d valid = _mm256_cmp_pd(x, xMin, _CMP_GE_OQ);
+            x = _mm256_max_pd(x, xMin);
+            __m256d k = _mm256_round_pd(_mm256_mul_pd(x, log2e), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+            __m256d r = _mm256_fnmadd_pd(k, ln2Lo, _mm256_fnmadd_pd(k, ln2Hi, x));
+            __m256d p = _mm256_set1_pd(1.0 / 39916800);
+            p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 3628800));
+            p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 362880));
+            p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 40320));
+            p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 5040));
+            p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 720));
+            p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 120));
+            p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 24));
+            p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 6));
+            p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(0.5));
+            p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1));
+            p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1));
+            __m256i exponent = _mm256_add_epi64(_mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(k)), _mm256_set1_epi64x(1023));
+            p = _mm256_mul_pd(p, _mm256_castsi256_pd(_mm256_slli_epi64(exponent, 52)));
+            _mm256_storeu_pd(values + i, _mm256_and_pd(p, valid));
         }
-        RANSAC::Terminate(bestModel, data, N);
+#endif
+        for (; i < n; i++)
+            values[i] = exp(scale * values[i] * values[i]);
     }
 
     int paramIterationEM;
 
+    double paramToleranceEM;
+
     double paramSigmaScale;
 
-    double* dataError2;
+    std::vector<std::vector<double> > dataGaussian;
 
     double dataSigma2;
 };
@@ -13,16 +13,48 @@ public:
     MSAC(Estimator<Model, Datum, Data>* estimator) : RANSAC<Model, Datum, Data>(estimator) { }
 
 protected:
+    using RANSAC<Model, Datum, Data>::paramThreshold;
+    using RANSAC<Model, Datum, Data>::BATCH_SIZE;
+
+    virtual bool FindBestLocation(Model& best, double& bestloss, const Data& data, int N)
+    {
+        std::vector<double> values;
+        if (!this->GetLocations(values, data, N)) return false;
+        double location = 0;
+        bestloss = LocationSolver<Model, Datum, Data>::FindMSAC(values, paramThreshold, location);
+        best = this->toolEstimator->GetLocationModel(location);
+        return true;
+    }
+
     virtual inline double EvaluateModel(const Model& model, const Data& data, int N)
     {
-        double loss = 0;
-        for (int i = 0; i < N; i++)
+        const double bound = this->GetEvaluationBound();
+        if (this->paramSPRT)
         {
-            double error = toolEstimator->ComputeError(model, data[i]);
-            if (error > paramThreshold || error < -paramThreshold) loss += paramThreshold * paramThreshold;
-            else loss += error * error;
+            const double threshold = paramThreshold;
+            return this->EvaluateModelSPRT(model, data, N, bound, [threshold](double error)
+            {
+                if (error > threshold || error < -threshold) return threshold * threshold;
+                return error * error;
+            });
         }
-        return loss;
+
+        const double threshold2 = paramThreshold * paramThreshold;
+        return this->SumBlocks(N, this->GetEvalThreadNum(N), [&](int begin, int end)
+        {
+            double loss = 0, errors[BATCH_SIZE];
+            for (int i = begin; i < end && loss <= bound; i += BATCH_SIZE)
+            {
+                const int size = this->GetBatchSize(i, end);
+                this->ComputeErrors(model, data, i, i + size, errors);
+                for (int k = 0; k < size; k++)
+                {
+                    double error2 = errors[k] * errors[k];
+                    loss += (error2 < threshold2) ? error2 : threshold2; // Branchless for vectorization
+                }
+            }
+            return loss;
+        });
     }
 };
 
@@ -0,0 +1,209 @@
+#ifndef __RTL_MAPPED__
+#define __RTL_MAPPED__
+
+#include <cstddef>
+#include <cstdio>
+
+#ifdef _WIN32
+    // Keep 'windows.h' from defining 'min' and 'max' macros, which break 'std::min' and 'std::max'
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+namespace RTL
+{
+
+// A read-only view of a flat binary file of 'T' records, which is mapped to memory instead of being loaded
+// - It can be used as 'Data' of estimators and algorithms (e.g. 'LineEstimatorT<MappedArray<Point> >'),
+//   so data larger than RAM are paged in by the OS only when they are accessed.
+// - The file is advised for sequential access, which suits batched evaluation over data (not SPRT with its random order).
+// - Indexing, 'data' and 'size' refer to a window of records, which is the whole file by default.
+//   The number of data given to algorithms is 'int', so a file of more than 2^31 - 1 records is processed window by window
+//   (e.g. 'FindBest' on a window of sampled size, and 'WriteMappedInliers' over all records).
+template <class T>
+class MappedArray
+{
+public:
+    MappedArray() : dataBegin(NULL), dataSize(0), windowBegin(NULL), windowSize(0) { Reset(); }
+
+    MappedArray(const char* path) : dataBegin(NULL), dataSize(0), windowBegin(NULL), windowSize(0)
+    {
+        Reset();
+        Open(path);
+    }
+
+    ~MappedArray() { Close(); }
+
+    // Map the given file (its trailing bytes which are not a whole record are ignored)
+    bool Open(const char* path)
+    {
+        Close();
+        if (path == NULL) return false;
+#ifdef _WIN32
+        fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (fileHandle == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER length;
+        if (!GetFileSizeEx(fileHandle, &length) || length.QuadPart < static_cast<LONGLONG>(sizeof(T))) return Fail();
+        mapHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapHandle == NULL) return Fail();
+        void* address = MapViewOfFile(mapHandle, FILE_MAP_READ, 0, 0, 0);
+        if (address == NULL) return Fail();
+        const size_t bytes = static_cast<size_t>(length.QuadPart);
+#else
+        fileHandle = open(path, O_RDONLY);
+        if (fileHandle < 0) return false;
+        struct stat status;
+        if (fstat(fileHandle, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(T))) return Fail();
+        const size_t bytes = static_cast<size_t>(status.st_size);
+        void* address = mmap(NULL, bytes, PROT_READ, MAP_SHARED, fileHandle, 0);
+        if (address == MAP_FAILED) return Fail();
+        madvise(address, bytes, MADV_SEQUENTIAL);
+#endif
+        mapBytes = bytes;
+        dataBegin = static_cast<const T*>(address);
+        dataSize = bytes / sizeof(T);
+        ResetWindow();
+        return true;
+    }
+
+    // Unmap the file
+    void Close(void)
+    {
+#ifdef _WIN32
+        if (dataBegin != NULL) UnmapViewOfFile(dataBegin);
+        if (mapHandle != NULL) CloseHandle(mapHandle);
+        if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+#else
+        if (dataBegin != NULL) munmap(const_cast<T*>(dataBegin), mapBytes);
+        if (fileHandle >= 0) close(fileHandle);
+#endif
+        Reset();
+    }
+
+    // Set the window of 'count' records from the 'begin'-th record (clipped at the end of the file)
+    bool SetWindow(size_t begin, size_t count)
+    {
+        if (dataBegin == NULL || begin > dataSize) return false;
+        windowBegin = dataBegin + begin;
+        windowSize = (count < dataSize - begin) ? count : (dataSize - begin);
+        return true;
+    }
+
+    // Set the window to the whole file
+    void ResetWindow(void)
+    {
+        windowBegin = dataBegin;
+        windowSize = dataSize;
+    }
+
+    // Get the index (in the file) of the first record of the window
+    size_t GetWindowBegin(void) const { return (dataBegin == NULL) ? 0 : static_cast<size_t>(windowBegin - dataBegin); }
+
+    // Get the number of all records in the file
+    size_t GetRecordNum(void) const { return dataSize; }
+
+    // Ask the OS to read records of the window from 'begin' to 'end - 1' ahead (e.g. before a random access to them)
+    void Prefetch(size_t begin, size_t end) const
+    {
+#ifndef _WIN32
+        if (dataBegin == NULL || begin >= end || end > windowSize) return;
+        const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        const size_t offset = GetWindowBegin();
+        const size_t first = ((offset + begin) * sizeof(T)) / page * page, last = (offset + end) * sizeof(T);
+        madvise(const_cast<char*>(reinterpret_cast<const char*>(dataBegin)) + first, last - first, MADV_WILLNEED);
+#endif
+    }
+
+    bool IsOpen(void) const { return dataBegin != NULL; }
+
+    const T& operator[](size_t i) const { return windowBegin[i]; }
+
+    const T* data(void) const { return windowBegin; }
+
+    size_t size(void) const { return windowSize; }
+
+    bool empty(void) const { return windowSize == 0; }
+
+protected:
+    void Reset(void)
+    {
+#ifdef _WIN32
+        fileHandle = INVALID_HANDLE_VALUE;
+        mapHandle = NULL;
+#else
+        fileHandle = -1;
+#endif
+        mapBytes = 0;
+        dataBegin = NULL;
+        dataSize = 0;
+        windowBegin = NULL;
+        windowSize = 0;
+    }
+
+    bool Fail(void)
+    {
+        Close();
+        return false;
+    }
+
+#ifdef _WIN32
+    HANDLE fileHandle;
+
+    HANDLE mapHandle;
+#else
+    int fileHandle;
+#endif
+
+    size_t mapBytes;
+
+    const T* dataBegin;
+
+    size_t dataSize;
+
+    const T* windowBegin;
+
+    size_t windowSize;
+
+private:
+    MappedArray(const MappedArray&);
+
+    MappedArray& operator=(const MappedArray&);
+}; // End of 'MappedArray'
+
+// Write inliers of the given model among all records of 'data' to a file, and return their number (-1: failure)
+// - Records are evaluated window by window of 'windowSize' records, so the file can have more than 2^31 - 1 records.
+//   The window of 'data' is restored at the end.
+// - 'algorithm' works on 'MappedArray<T>' (e.g. 'RANSAC'), and the file has indices in the whole file or a bitmask
+//   as 'RANSAC::WriteInliers'. 'windowSize' should be a multiple of 8 for a bitmask.
+template <class Algorithm, class Model, class T>
+long long WriteMappedInliers(Algorithm& algorithm, const Model& model, MappedArray<T>& data, const char* path, bool bitmask = false, size_t windowSize = 1 << 30)
+{
+    if (!data.IsOpen() || windowSize == 0 || windowSize > 0x7FFFFFFF) return -1;
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) return -1;
+    const size_t windowBegin = data.GetWindowBegin(), windowCount = data.size();
+    long long count = 0;
+    for (size_t begin = 0; begin < data.GetRecordNum() && count >= 0; begin += windowSize)
+    {
+        data.SetWindow(begin, windowSize);
+        const long long found = algorithm.WriteInliers(model, data, static_cast<int>(data.size()), file, bitmask, static_cast<long long>(begin));
+        count = (found < 0) ? -1 : (count + found);
+    }
+    data.SetWindow(windowBegin, windowCount);
+    if (fclose(file) != 0) count = -1;
+    return count;
+}
+
+} // End of 'RTL'
+
+#endif // End of '__RTL_MAPPED__'
@@ -0,0 +1,147 @@
+#ifndef __RTL_NAPSAC__
+#define __RTL_NAPSAC__
+
+#include "Sampler.hpp"
+#include <cmath>
+#include <vector>
+
+namespace RTL
+{
+
+// NAPSAC sample selection which draws samples from a spatial neighborhood
+// - Ref. D. R. Myatt et al., NAPSAC: High Noise, High Dimensional Robust Estimation - It's in the Bag, BMVC, 2002
+// - The first sample is drawn uniformly, and the others are drawn from its cell and 8 adjacent cells of a uniform grid.
+//   Inliers of a structure are denser around each other than outliers, so samples are more likely to be all inliers.
+// - The grid is built once in 'Initialize', where each cell has about 'paramCellPoints' data on average.
+// - If a neighborhood has less than 'M' data, samples are drawn uniformly from all data.
+// - It only supports 2-D data, where a datum should have its coordinates as 'x' and 'y' (e.g. 'Point').
+//   The grid ignores any other coordinate (e.g. 'z' of 'Point3'), so neighbors of such data are not spatial neighbors.
+template <class Data>
+class NAPSACSampler : public Sampler<Data>
+{
+public:
+    NAPSACSampler() { SetParamCellPoints(); }
+
+    virtual void Initialize(const Data& data, int N)
+    {
+        Sampler<Data>::Initialize(data, N);
+        if (N <= 0) return;
+
+        // Find the bounding box and the cell size
+        double xMin = data[this->GetIndex(0)].x, xMax = xMin, yMin = data[this->GetIndex(0)].y, yMax = yMin;
+        for (int i = 1; i < N; i++)
+        {
+            const double x = data[this->GetIndex(i)].x, y = data[this->GetIndex(i)].y;
+            if (x < xMin) xMin = x;
+            if (x > xMax) xMax = x;
+            if (y < yMin) yMin = y;
+            if (y > yMax) yMax = y;
+        }
+        const double width = xMax - xMin, height = yMax - yMin;
+        const double ratio = static_cast<double>(paramCellPoints) / N;
+        double size = sqrt(width * height * ratio);
+        const double sizeLine = std::max(width, height) * ratio; // For data on a horizontal or vertical line
+        if (size < sizeLine) size = sizeLine;
+        gridX = 1;
+        gridY = 1;
+        if (size > 0)
+        {
+            gridX = std::min(static_cast<int>(width / size) + 1, N);
+            gridY = std::min(static_cast<int>(height / size) + 1, N);
+            cellScale = 1 / size;
+        }
+        else cellScale = 0;
+        cellX = xMin;
+        cellY = yMin;
+
+        // Sort data by their cells (counting sort)
+        dataCell.resize(N);
+        cellBegin.assign(gridX * gridY + 1, 0);
+        for (int i = 0; i < N; i++)
+        {
+            const int cx = std::min(static_cast<int>((data[this->GetIndex(i)].x - cellX) * cellScale), gridX - 1);
+            const int cy = std::min(static_cast<int>((data[this->GetIndex(i)].y - cellY) * cellScale), gridY - 1);
+            dataCell[i] = cy * gridX + cx;
+            cellBegin[dataCell[i] + 1]++;
+        }
+        for (size_t c = 1; c < cellBegin.size(); c++) cellBegin[c] += cellBegin[c - 1];
+        cellData.resize(N);
+        dataSlot.resize(N);
+        std::vector<int> filled(cellBegin.begin(), cellBegin.end() - 1);
+        for (int i = 0; i < N; i++)
+        {
+            dataSlot[i] = filled[dataCell[i]]++;
+            cellData[dataSlot[i]] = i;
+        }
+    }
+
+    virtual void Draw(int* samples, int M, Xoshiro256& generator)
+    {
+        const int N = this->dataNum;
+        samples[0] = generator.Uniform(N);
+        if (M <= 1) return;
+
+        // Collect ranges of data in the neighborhood of the first sample
+        const int cell = dataCell[samples[0]], cx = cell % gridX, cy = cell / gridX;
+        int rangeBegin[3], rangeEnd[3], rangeNum = 0, count = 0, first = 0;
+        for (int y = std::max(cy - 1, 0); y <= std::min(cy + 1, gridY - 1); y++)
+        {
+            // Adjacent cells in a row are contiguous in 'cellData'
+            const int begin = cellBegin[y * gridX + std::max(cx - 1, 0)], end = cellBegin[y * gridX + std::min(cx + 1, gridX - 1) + 1];
+            if (y == cy) first = count + dataSlot[samples[0]] - begin;
+            rangeBegin[rangeNum] = begin;
+            rangeEnd[rangeNum] = end;
+            rangeNum++;
+            count += end - begin;
+        }
+        if (count < M)
+        {
+            DrawUniform(samples, M, N, generator);
+            return;
+        }
+
+        // Draw the others from the neighborhood except the first sample
+        DrawUniform(samples + 1, M - 1, count - 1, generator);
+        for (int m = 1; m < M; m++)
+        {
+            int offset = samples[m] + (samples[m] >= first);
+            int r = 0;
+            while (offset >= rangeEnd[r] - rangeBegin[r])
+            {
+                offset -= rangeEnd[r] - rangeBegin[r];
+                r++;
+            }
+            samples[m] = cellData[rangeBegin[r] + offset];
+        }
+    }
+
+    // Set the average number of data in a cell of the grid
+    void SetParamCellPoints(int number = 8) { paramCellPoints = number; }
+
+    int GetParamCellPoints(void) { return paramCellPoints; }
+
+protected:
+    int paramCellPoints;
+
+    int gridX;
+
+    int gridY;
+
+    double cellX;
+
+    double cellY;
+
+    double cellScale;
+
+    std::vector<int> cellBegin;
+
+    std::vector<int> cellData;
+
+    std::vector<int> dataCell;
+
+    std::vector<int> dataSlot;
+}; // End of 'NAPSACSampler'
+
+} // End of 'RTL'
+
+#endif // End of '__RTL_NAPSAC__'
@@ -0,0 +1,262 @@
+#ifndef __RTL_PROSAC__
+#define __RTL_PROSAC__
+
+#include "RANSAC.hpp"
+#include <algorithm>
+
+namespace RTL
+{
+
+// PROSAC which draws samples progressively from data with higher quality
+// - Ref. O. Chum and J. Matas, Matching with PROSAC - Progressive Sample Consensus, CVPR, 2005
+// - Samples are drawn from the top 'n' data in the quality order, where 'n' grows following the PROSAC growth function.
+// - It stops when the best model satisfies the non-randomness and maximality criteria (with 'paramConfidence'),
+//   which can happen after a few iterations with well-ordered data ('paramIterationMin' can guarantee more iterations).
+// - It only changes hypothesis generation and termination, so it can be combined with other losses by multiple inheritance,
+//   e.g. 'class PROSACMSAC : public PROSAC<Model, Datum, Data>, public MSAC<Model, Datum, Data>'.
+// - When hypotheses are searched by multiple threads, their order of sampling is not reproducible.
+template <class Model, class Datum, class Data>
+class PROSAC : virtual public RANSAC<Model, Datum, Data>
+{
+public:
+    PROSAC(Estimator<Model, Datum, Data>* estimator) : RANSAC<Model, Datum, Data>(estimator)
+    {
+        this->SetParamConfidence(0.95);
+        SetParamGrowthIteration();
+        SetParamRandomInlier();
+        SetParamRandomError();
+        SetParamStoppingLengthMin();
+    }
+
+    // Set the quality of each datum (higher is better), which orders data for sampling
+    void SetQuality(const std::vector<double>& quality)
+    {
+        std::vector<int> order(quality.size());
+        for (size_t i = 0; i < order.size(); i++) order[i] = static_cast<int>(i);
+        std::stable_sort(order.begin(), order.end(), [&quality](int a, int b) { return quality[a] > quality[b]; });
+        SetOrder(order);
+    }
+
+    // Set the indices of data from the best quality to the worst (empty: data are already sorted)
+    // - It should have all 'N' data of 'FindBest', which fails with 'HUGE_VAL' otherwise.
+    // - With 'FindMultiple', it has all data, and only the remaining data are drawn in the same order.
+    void SetOrder(const std::vector<int>& order) { dataRank = order; }
+
+    virtual double FindBest(Model& best, const Data& data, int N, int M)
+    {
+        if (!PrepareRank(N)) return HUGE_VAL;
+        return RANSAC<Model, Datum, Data>::FindBest(best, data, N, M);
+    }
+
+    // Set the number of iterations after which PROSAC draws samples from all data as RANSAC
+    void SetParamGrowthIteration(int iteration = 200000) { paramGrowthIteration = iteration; }
+
+    int GetParamGrowthIteration(void) { return paramGrowthIteration; }
+
+    // Set the probability that a datum is an inlier of a wrong model (for the non-randomness criterion)
+    void SetParamRandomInlier(double probability = 0.05) { paramRandomInlier = probability; }
+
+    double GetParamRandomInlier(void) { return paramRandomInlier; }
+
+    // Set the probability that a wrong model is accepted by chance (for the non-randomness criterion)
+    void SetParamRandomError(double probability = 0.05) { paramRandomError = probability; }
+
+    double GetParamRandomError(void) { return paramRandomError; }
+
+    // Set the minimum length 'n*' where sampling can stop growing
+    // - A sample is always non-random among the top 'n' data when 'n' is close to 'M', so such lengths would stop the growth.
+    void SetParamStoppingLengthMin(int length = 20) { paramStoppingLengthMin = length; }
+
+    int GetParamStoppingLengthMin(void) { return paramStoppingLengthMin; }
+
+protected:
+    using RANSAC<Model, Datum, Data>::toolEstimator;
+    using RANSAC<Model, Datum, Data>::toolGenerators;
+    using RANSAC<Model, Datum, Data>::paramThreshold;
+    using RANSAC<Model, Datum, Data>::paramConfidence;
+    using RANSAC<Model, Datum, Data>::paramSampleSize;
+    using RANSAC<Model, Datum, Data>::dataSamples;
+    using RANSAC<Model, Datum, Data>::dataIterationRequired;
+    using RANSAC<Model, Datum, Data>::dataIndex;
+
+    // Prepare the order of 'N' data for sampling, where each is a position among data accessed through 'dataIndex'
+    // - It returns false if the given order does not have all data.
+    bool PrepareRank(int N)
+    {
+        dataRankActive.clear();
+        if (dataRank.empty())
+        {
+            dataRankActive.resize(N);
+            for (int i = 0; i < N; i++) dataRankActive[i] = i;
+            return true;
+        }
+        if (dataIndex == NULL)
+        {
+            if (static_cast<int>(dataRank.size()) != N) return false;
+            dataRankActive = dataRank;
+            return true;
+        }
+
+        // Keep data in 'dataIndex' in the given order (e.g. the remaining data of 'FindMultiple')
+        std::vector<int> position(dataRank.size(), -1);
+        for (int i = 0; i < N; i++)
+        {
+            if (dataIndex[i] < 0 || dataIndex[i] >= static_cast<int>(position.size())) return false;
+            position[dataIndex[i]] = i;
+        }
+        for (size_t r = 0; r < dataRank.size(); r++)
+        {
+            const int index = dataRank[r];
+            if (index >= 0 && index < static_cast<int>(position.size()) && position[index] >= 0) dataRankActive.push_back(position[index]);
+        }
+        return static_cast<int>(dataRankActive.size()) == N;
+    }
+
+    virtual void Initialize(const Data& data, int N)
+    {
+        RANSAC<Model, Datum, Data>::Initialize(data, N);
+
+        const int M = paramSampleSize;
+
+        // Initialize the growth function
+        dataT = 0;
+        dataN = M;
+        dataNStop = N;
+        dataTn = paramGrowthIteration;
+        for (int i = 0; i < M; i++) dataTn *= static_cast<double>(M - i) / (N - i);
+        dataTnPrime = 1;
+
+        // Prepare the minimum number of inliers for each 'n' to be non-random (using the normal approximation)
+        const double chi = GetNormalQuantile(1 - paramRandomError);
+        dataInlierMin.assign(N + 1, 0);
+        for (int n = M; n <= N; n++)
+        {
+            double mean = (n - M) * paramRandomInlier, sigma = sqrt((n - M) * paramRandomInlier * (1 - paramRandomInlier));
+            dataInlierMin[n] = M + static_cast<int>(ceil(mean + chi * sigma));
+        }
+        dataInput = &data;
+        dataErrors.resize(N);
+    }
+
+    virtual Model GenerateModel(const Data& data, int M)
+    {
+        // Grow the sampling range
+        int n;
+        bool useTn;
+#pragma omp critical(RTL_PROSAC)
+        {
+            dataT++;
+            if (dataT > dataTnPrime && dataN < dataNStop)
+            {
+                double TnNext = dataTn * (dataN + 1) / (dataN + 1 - M);
+                dataTnPrime += static_cast<int>(ceil(TnNext - dataTn));
+                dataTn = TnNext;
+                dataN++;
+            }
+            n = dataN;
+            useTn = (dataTnPrime >= dataT);
+        }
+
+        // Draw samples from the top 'n' data (always including the 'n'-th one if 'T'_n' is not passed)
+        // - Invalid samples are redrawn from the same 'n' without growing it.
+        const int thread = this->GetThreadIndex();
+        Xoshiro256& generator = toolGenerators[thread];
+        const std::vector<int>& rank = dataRankActive;
+        return this->GenerateValidModel(data, &dataSamples[thread * M], M, [n, useTn, &generator, &rank](int* samples, int M)
+        {
+            if (useTn)
+            {
+                DrawUniform(samples, M - 1, n - 1, generator);
+                samples[M - 1] = n - 1;
+            }
+            else DrawUniform(samples, M, n, generator);
+            for (int m = 0; m < M; m++) samples[m] = rank[samples[m]];
+        });
+    }
+
+    virtual bool UpdateBest(Model& bestModel, double& bestCost, const Model& model, double cost)
+    {
+        if (!RANSAC<Model, Datum, Data>::UpdateBest(bestModel, bestCost, model, cost)) return false;
+        UpdateStoppingLength(bestModel);
+        return true;
+    }
+
+    // Find the length 'n*' which needs the least iterations among lengths whose inliers are not random
+    void UpdateStoppingLength(const Model& bestModel)
+    {
+        const int N = static_cast<int>(dataRankActive.size()), M = paramSampleSize;
+        this->ComputeErrors(bestModel, *dataInput, 0, N, &dataErrors[0]);
+
+        int inliers = 0;
+        for (int i = 0; i < M - 1; i++) inliers += (fabs(dataErrors[dataRankActive[i]]) < paramThreshold);
+        double iterationMin = HUGE_VAL;
+        for (int n = M; n <= N; n++)
+        {
+            inliers += (fabs(dataErrors[dataRankActive[n - 1]]) < paramThreshold);
+            if (n < paramStoppingLengthMin && n < N) continue;
+            if (inliers < dataInlierMin[n]) continue;
+
+            // Maximality
+            double probAllInlier = pow(static_cast<double>(inliers) / n, M), iteration = 0;
+            if (probAllInlier < 1) iteration = (probAllInlier > 0) ? (log(1 - paramConfidence) / log(1 - probAllInlier)) : HUGE_VAL;
+            if (iteration < iterationMin)
+            {
+                iterationMin = iteration;
+                dataNStop = n;
+            }
+        }
+        if (iterationMin < dataIterationRequired) dataIterationRequired = static_cast<int>(ceil(iterationMin));
+    }
+
+    // Get the 'p' quantile of the standard normal distribution
+    // - Ref. P. J. Acklam's rational approximation (whose relative error is less than 1.15e-9)
+    static double GetNormalQuantile(double p)
+    {
+        static const double a[] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02, 1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+        static const double b[] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02, 6.680131188771972e+01, -1.328068155288572e+01 };
+        static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00, -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+        static const double d[] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00, 3.754408661907416e+00 };
+        if (p <= 0) return -HUGE_VAL;
+        if (p >= 1) return HUGE_VAL;
+        if (p < 0.02425)
+        {
+            double q = sqrt(-2 * log(p));
+            return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+        }
+        if (p > 1 - 0.02425) return -GetNormalQuantile(1 - p);
+        double q = p - 0.5, r = q * q;
+        return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+    }
+
+    int paramGrowthIteration;
+
+    double paramRandomInlier;
+
+    double paramRandomError;
+
+    int paramStoppingLengthMin;
+
+    std::vector<int> dataRank;
+
+    std::vector<int> dataRankActive;
+
+    std::vector<int> dataInlierMin;
+
+    std::vector<double> dataErrors;
+
+    const Data* dataInput;
+
+    int dataT;
+
+    int dataN;
+
+    int dataNStop;
+
+    double dataTn;
+
+    int dataTnPrime;
+};
+
+} // End of 'RTL'
+
+#endif // End of '__RTL_PROSAC__'
@@ -0,0 +1,345 @@
+#ifndef __RTL_PLANE__
+#define __RTL_PLANE__
+
+#include "Base.hpp"
+#include <cmath>
+#include <cfloat>
+#include <ostream>
+#include <random>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#   include <immintrin.h>
+#endif
+
+class Point3
+{
+public:
+    Point3() : x(0), y(0), z(0) { }
+
+    Point3(double _x, double _y, double _z) : x(_x), y(_y), z(_z) { }
+
+    friend std::ostream& operator<<(std::ostream& out, const Point3& p) { return out << p.x << ", " << p.y << ", " << p.z; }
+
+    double x, y, z;
+};
+
+// A plane, 'a * x + b * y + c * z + d = 0', whose normal vector '(a, b, c)' is a unit vector
+class Plane
+{
+public:
+    Plane() : a(0), b(0), c(0), d(0) { }
+
+    Plane(double _a, double _b, double _c, double _d) : a(_a), b(_b), c(_c), d(_d) { }
+
+    friend std::ostream& operator<<(std::ostream& out, const Plane& p) { return out << p.a << ", " << p.b << ", " << p.c << ", " << p.d; }
+
+    double a, b, c, d;
+};
+
+// A structure-of-arrays container of 3D points for vectorized evaluation
+class Point3Array
+{
+public:
+    Point3Array() { }
+
+    Point3Array(const std::vector<Point3>& points)
+    {
+        reserve(points.size());
+        for (size_t i = 0; i < points.size(); i++) push_back(points[i]);
+    }
+
+    Point3 operator[](size_t i) const { return Point3(x[i], y[i], z[i]); }
+
+    void push_back(const Point3& p)
+    {
+        x.push_back(p.x);
+        y.push_back(p.y);
+        z.push_back(p.z);
+    }
+
+    void reserve(size_t n)
+    {
+        x.reserve(n);
+        y.reserve(n);
+        z.reserve(n);
+    }
+
+    void clear(void)
+    {
+        x.clear();
+        y.clear();
+        z.clear();
+    }
+
+    size_t size(void) const { return x.size(); }
+
+    bool empty(void) const { return x.empty(); }
+
+    std::vector<double> x, y, z;
+};
+
+template <class Data>
+class PlaneEstimatorT : virtual public RTL::Estimator<Plane, Point3, Data>
+{
+public:
+    virtual Plane ComputeModel(const Data& data, const std::set<int>& samples)
+    {
+        return FitModel(data, samples.begin(), samples.end());
+    }
+
+    // Calculate a plane through 3 points, or fit a plane to more points (least squares)
+    virtual Plane ComputeModel(const Data& data, const int* samples, int M)
+    {
+        if (M != 3) return FitModel(data, samples, samples + M);
+
+        const Point3 p = data[samples[0]], q = data[samples[1]], r = data[samples[2]];
+        const double ux = q.x - p.x, uy = q.y - p.y, uz = q.z - p.z;
+        const double vx = r.x - p.x, vy = r.y - p.y, vz = r.z - p.z;
+        double a = uy * vz - uz * vy, b = uz * vx - ux * vz, c = ux * vy - uy * vx;
+        const double norm = sqrt(a * a + b * b + c * c);
+        if (norm <= 0) return Plane();
+        a /= norm;
+        b /= norm;
+        c /= norm;
+        return Plane(a, b, c, -(a * p.x + b * p.y + c * p.z));
+    }
+
+    virtual double ComputeError(const Plane& plane, const Point3& point)
+    {
+        return plane.a * point.x + plane.b * point.y + plane.c * point.z + plane.d;
+    }
+
+    // Check whether 3 samples are not collinear (or more samples are not all coincident)
+    virtual bool IsSampleValid(const Data& data, const int* samples, int M)
+    {
+        const Point3 p = data[samples[0]];
+        if (M == 3)
+        {
+            const Point3 q = data[samples[1]], r = data[samples[2]];
+            const double ux = q.x - p.x, uy = q.y - p.y, uz = q.z - p.z;
+            const double vx = r.x - p.x, vy = r.y - p.y, vz = r.z - p.z;
+            const double a = uy * vz - uz * vy, b = uz * vx - ux * vz, c = ux * vy - uy * vx;
+            return (a * a + b * b + c * c) > DBL_EPSILON * (ux * ux + uy * uy + uz * uz) * (vx * vx + vy * vy + vz * vz);
+        }
+        for (int m = 1; m < M; m++)
+        {
+            const Point3 q = data[samples[m]];
+            if (q.x != p.x || q.y != p.y || q.z != p.z) return true;
+        }
+        return false;
+    }
+
+    // Check whether the plane is finite and has its normal vector
+    virtual bool IsModelValid(const Plane& plane)
+    {
+        return std::isfinite(plane.a) && std::isfinite(plane.b) && std::isfinite(plane.c) && std::isfinite(plane.d) && (plane.a != 0 || plane.b != 0 || plane.c != 0);
+    }
+
+    virtual void ComputeErrors(const Plane& plane, const Data& data, int begin, int end, double* errors)
+    {
+        for (int i = begin; i < end; i++)
+        {
+            const Point3 p = data[i];
+            errors[i - begin] = plane.a * p.x + plane.b * p.y + plane.c * p.z + plane.d;
+        }
+    }
+
+    virtual void ComputeIndexedErrors(const Plane& plane, const Data& data, const int* indices, int n, double* errors)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            const Point3 p = data[indices[i]];
+            errors[i] = plane.a * p.x + plane.b * p.y + plane.c * p.z + plane.d;
+        }
+    }
+
+    // Fit a plane to 'M' points from sums of their coordinates and their products
+    // - The normal vector is the eigen vector of the covariance matrix with the smallest eigen value.
+    static Plane FitPlane(int M, const double sum[3], const double sum2[6])
+    {
+        const double mean[3] = { sum[0] / M, sum[1] / M, sum[2] / M };
+        double A[3][3];
+        A[0][0] = sum2[0] / M - mean[0] * mean[0];
+        A[1][1] = sum2[1] / M - mean[1] * mean[1];
+        A[2][2] = sum2[2] / M - mean[2] * mean[2];
+        A[0][1] = A[1][0] = sum2[3] / M - mean[0] * mean[1];
+        A[0][2] = A[2][0] = sum2[4] / M - mean[0] * mean[2];
+        A[1][2] = A[2][1] = sum2[5] / M - mean[1] * mean[2];
+
+        // Diagonalize the symmetric matrix by Jacobi rotations
+        double V[3][3] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+        for (int sweep = 0; sweep < 50; sweep++)
+        {
+            const double off = A[0][1] * A[0][1] + A[0][2] * A[0][2] + A[1][2] * A[1][2];
+            const double diag = A[0][0] * A[0][0] + A[1][1] * A[1][1] + A[2][2] * A[2][2];
+            if (off <= DBL_EPSILON * DBL_EPSILON * diag) break;
+            for (int p = 0; p < 2; p++)
+            {
+                for (int q = p + 1; q < 3; q++)
+                {
+                    if (A[p][q] == 0) continue;
+                    const double theta = (A[q][q] - A[p][p]) / (2 * A[p][q]);
+                    const double t = ((theta >= 0) ? 1 : -1) / (fabs(theta) + sqrt(theta * theta + 1));
+                    const double c = 1 / sqrt(t * t + 1), s = t * c;
+                    for (int k = 0; k < 3; k++)
+                    {
+                        const double akp = A[k][p], akq = A[k][q];
+                        A[k][p] = c * akp - s * akq;
+                        A[k][q] = s * akp + c * akq;
+                    }
+                    for (int k = 0; k < 3; k++)
+                    {
+                        const double apk = A[p][k], aqk = A[q][k];
+                        A[p][k] = c * apk - s * aqk;
+                        A[q][k] = s * apk + c * aqk;
+                        const double vkp = V[k][p], vkq = V[k][q];
+                        V[k][p] = c * vkp - s * vkq;
+                        V[k][q] = s * vkp + c * vkq;
+                    }
+                }
+            }
+        }
+        int smallest = 0;
+        if (A[1][1] < A[smallest][smallest]) smallest = 1;
+        if (A[2][2] < A[smallest][smallest]) smallest = 2;
+
+        const double a = V[0][smallest], b = V[1][smallest], c = V[2][smallest];
+        return Plane(a, b, c, -(a * mean[0] + b * mean[1] + c * mean[2]));
+    }
+
+    virtual RTL::Accumulator<Plane, Point3>* CreateAccumulator(void) { return new PlaneAccumulator(); }
+
+    // An incremental plane estimator which keeps the sums of 'PlaneEstimatorT::FitModel'
+    class PlaneAccumulator : public RTL::Accumulator<Plane, Point3>
+    {
+    public:
+        PlaneAccumulator() { Clear(); }
+
+        virtual void Clear(void)
+        {
+            count = 0;
+            for (int k = 0; k < 3; k++) sum[k] = 0;
+            for (int k = 0; k < 6; k++) sum2[k] = 0;
+        }
+
+        virtual void Add(const Point3& p) { AddSums(count, sum, sum2, p, 1); }
+
+        virtual void Remove(const Point3& p) { AddSums(count, sum, sum2, p, -1); }
+
+        virtual int GetCount(void) { return count; }
+
+        virtual Plane ComputeModel(void) { return FitPlane(count, sum, sum2); }
+
+    protected:
+        int count;
+
+        double sum[3], sum2[6];
+    };
+
+protected:
+    // Add (or subtract with 'sign = -1') a point to sums of coordinates and their products
+    // - 'sum2' has 'xx', 'yy', 'zz', 'xy', 'xz', and 'yz'.
+    static void AddSums(int& count, double sum[3], double sum2[6], const Point3& p, int sign)
+    {
+        count += sign;
+        sum[0] += sign * p.x;
+        sum[1] += sign * p.y;
+        sum[2] += sign * p.z;
+        sum2[0] += sign * p.x * p.x;
+        sum2[1] += sign * p.y * p.y;
+        sum2[2] += sign * p.z * p.z;
+        sum2[3] += sign * p.x * p.y;
+        sum2[4] += sign * p.x * p.z;
+        sum2[5] += sign * p.y * p.z;
+    }
+
+    // Fit a plane to data at the given indices using their first and second moments
+    template <class Iterator>
+    Plane FitModel(const Data& data, Iterator begin, Iterator end)
+    {
+        int count = 0;
+        double sum[3] = { 0, 0, 0 }, sum2[6] = { 0, 0, 0, 0, 0, 0 };
+        for (Iterator itr = begin; itr != end; itr++)
+            AddSums(count, sum, sum2, data[*itr], 1);
+        return FitPlane(count, sum, sum2);
+    }
+}; // End of 'PlaneEstimatorT'
+
+// Calculate errors of points in the structure-of-arrays (with AVX2 and FMA if they are enabled, e.g. '-mavx2 -mfma')
+template <>
+inline void PlaneEstimatorT<Point3Array>::ComputeErrors(const Plane& plane, const Point3Array& data, int begin, int end, double* errors)
+{
+    const double* x = data.x.data();
+    const double* y = data.y.data();
+    const double* z = data.z.data();
+    int i = begin;
+#if defined(__AVX2__) && defined(__FMA__)
+    const __m256d a = _mm256_set1_pd(plane.a), b = _mm256_set1_pd(plane.b), c = _mm256_set1_pd(plane.c), d = _mm256_set1_pd(plane.d);
+    for (; i + 4 <= end; i += 4)
+    {
+        __m256d e = _mm256_fmadd_pd(c, _mm256_loadu_pd(z + i), d);
+        e = _mm256_fmadd_pd(b, _mm256_loadu_pd(y + i), e);
+        e = _mm256_fmadd_pd(a, _mm256_loadu_pd(x + i), e);
+        _mm256_storeu_pd(errors + i - begin, e);
+    }
+#endif
+    for (; i < end; i++)
+        errors[i - begin] = plane.a * x[i] + plane.b * y[i] + plane.c * z[i] + plane.d;
+}
+
+typedef PlaneEstimatorT<std::vector<Point3> > PlaneEstimator;
+
+class PlaneObserver : virtual public RTL::Observer<Plane, Point3, std::vector<Point3> >
+{
+public:
+    PlaneObserver(Point3 _max = Point3(100, 100, 100), Point3 _min = Point3(0, 0, 0)) : RANGE_MAX(_max), RANGE_MIN(_min) { SetSeed(); }
+
+    // Set the seed of the random number generator, which is restarted for each 'GenerateData'
+    void SetSeed(unsigned int seed = std::mt19937::default_seed) { generatorSeed = seed; }
+
+    // Generate points on the plane (with Gaussian noise) and outliers uniformly in the range
+    // - Inliers are drawn uniformly on two axes, and their coordinate on the axis closest to the normal is solved on the plane.
+    virtual std::vector<Point3> GenerateData(const Plane& plane, int N, std::vector<int>& inliers, double noise = 0, double ratio = 1)
+    {
+        std::mt19937 generator(generatorSeed);
+        std::uniform_real_distribution<double> uniform(0, 1);
+        std::normal_distribution<double> normal(0, 1);
+
+        const double normal3[3] = { plane.a, plane.b, plane.c };
+        const double rangeMin[3] = { RANGE_MIN.x, RANGE_MIN.y, RANGE_MIN.z }, rangeMax[3] = { RANGE_MAX.x, RANGE_MAX.y, RANGE_MAX.z };
+        int axis = 0;
+        if (fabs(normal3[1]) > fabs(normal3[axis])) axis = 1;
+        if (fabs(normal3[2]) > fabs(normal3[axis])) axis = 2;
+        if (normal3[axis] == 0) return std::vector<Point3>();
+
+        std::vector<Point3> data;
+        data.reserve(N);
+        for (int i = 0; i < N; i++)
+        {
+            double coord[3];
+            for (int k = 0; k < 3; k++) coord[k] = (rangeMax[k] - rangeMin[k]) * uniform(generator) + rangeMin[k];
+            double vote = uniform(generator);
+            if (vote <= ratio)
+            {
+                // Generate an inlier
+                double dot = plane.d;
+                for (int k = 0; k < 3; k++)
+                    if (k != axis) dot += normal3[k] * coord[k];
+                coord[axis] = -dot / normal3[axis];
+                for (int k = 0; k < 3; k++) coord[k] += noise * normal(generator);
+                inliers.push_back(i);
+            }
+            data.push_back(Point3(coord[0], coord[1], coord[2]));
+        }
+        return data;
+    }
+
+    const Point3 RANGE_MAX;
+
+    const Point3 RANGE_MIN;
+
+protected:
+    unsigned int generatorSeed;
+};
+
+#endif // End of '__RTL_PLANE__'
@@ -0,0 +1,143 @@
+#ifndef __RTL_PREEMPTIVE_RANSAC__
+#define __RTL_PREEMPTIVE_RANSAC__
+
+#include "RANSAC.hpp"
+#include "Evaluator.hpp"
+#include <algorithm>
+
+namespace RTL
+{
+
+// Preemptive RANSAC which evaluates a fixed number of hypotheses breadth-first
+// - Ref. D. Nister, Preemptive RANSAC for Live Structure and Motion Estimation, ICCV, 2003
+// - All hypotheses are generated at first ('paramIteration' is their number), and they are scored together on blocks of data
+//   in a random order. After each block, the worse half of hypotheses are discarded, so the cost of each call is bounded.
+template <class Model, class Datum, class Data>
+class PreemptiveRANSAC : virtual public RANSAC<Model, Datum, Data>
+{
+public:
+    PreemptiveRANSAC(Estimator<Model, Datum, Data>* estimator) : RANSAC<Model, Datum, Data>(estimator)
+    {
+        SetParamBlockSize();
+        SetParamTimeBudget();
+    }
+
+    // Find the best model
+    // - The returned loss is accumulated on the scored data, not all data.
+    virtual double FindBest(Model& best, const Data& data, int N, int M)
+    {
+        assert(N > 0 && M > 0);
+
+        StopWatch watch;
+        RTL_STAT(long long timeBegin = Statistics::GetTime());
+        this->paramSampleSize = M;
+        this->Initialize(data, N);
+
+        // 1. Generate hypotheses (using at most half of the time budget)
+        std::vector<Model> models;
+        models.reserve(paramIteration);
+        while (static_cast<int>(models.size()) < paramIteration)
+        {
+            if (paramTimeBudget > 0 && !models.empty() && watch.GetElapse() > paramTimeBudget / 2) break;
+            models.push_back(this->GenerateModel(data, M));
+        }
+        dataIteration = static_cast<int>(models.size());
+        if (models.empty())
+        {
+            this->Terminate(best, data, N);
+            RTL_STAT(this->ReportStatistics(timeBegin));
+            return HUGE_VAL;
+        }
+
+        // Prepare a random order of data which are possibly scored
+        const int hypothesisNum = static_cast<int>(models.size());
+        int blockNum = 1;
+        while ((hypothesisNum >> blockNum) > 0) blockNum++;
+        const int scoreNum = std::min(N, blockNum * paramBlockSize);
+        dataOrder.resize(N);
+        for (int i = 0; i < N; i++) dataOrder[i] = i;
+        Xoshiro256& generator = toolGenerators[0];
+        for (int i = 0; i < scoreNum; i++)
+            std::swap(dataOrder[i], dataOrder[i + generator.Uniform(N - i)]);
+
+        // 2. Evaluate hypotheses on each block and keep the better half
+        RTL_STAT(long long tic = Statistics::GetTime());
+        std::vector<double> losses(hypothesisNum, 0);
+        std::vector<int> inlierNums(hypothesisNum, 0);
+        std::vector<int> alive(hypothesisNum);
+        for (int h = 0; h < hypothesisNum; h++) alive[h] = h;
+        int scored = 0;
+        for (int block = 1; scored < scoreNum && alive.size() > 1; block++)
+        {
+            const int end = std::min(scoreNum, scored + paramBlockSize);
+            for (size_t k = 0; k < alive.size(); k++)
+            {
+                const int h = alive[k];
+                for (int j = scored; j < end; j++)
+                {
+                    double error = toolEstimator->ComputeError(models[h], data[this->GetIndex(dataOrder[j])]);
+                    losses[h] += ComputeLoss(error);
+                    inlierNums[h] += (fabs(error) < paramThreshold);
+                }
+            }
+            RTL_STAT(this->statPointNum += static_cast<long long>(end - scored) * alive.size());
+            scored = end;
+
+            // Discard the worse half
+            size_t keep = std::max(hypothesisNum >> block, 1);
+            if (keep < alive.size())
+            {
+                RTL_STAT(this->dataStatistics.worseNum += static_cast<int>(alive.size() - keep));
+                std::nth_element(alive.begin(), alive.begin() + keep, alive.end(), [&losses](int a, int b) { return (losses[a] < losses[b]) || (losses[a] == losses[b] && a < b); });
+                alive.resize(keep);
+            }
+            if (paramTimeBudget > 0 && watch.GetElapse() > paramTimeBudget) break;
+        }
+
+        // Select the best one among the remaining hypotheses
+        int bestIndex = alive[0];
+        for (size_t k = 1; k < alive.size(); k++)
+            if (losses[alive[k]] < losses[bestIndex] || (losses[alive[k]] == losses[bestIndex] && alive[k] < bestIndex)) bestIndex = alive[k];
+        best = models[bestIndex];
+        dataInlierRatio = (scored > 0) ? static_cast<double>(inlierNums[bestIndex]) / scored : 0;
+        RTL_STAT(this->statTimeEvaluate += Statistics::GetTime() - tic);
+        this->Terminate(best, data, N);
+        RTL_STAT(this->ReportStatistics(timeBegin));
+        return losses[bestIndex];
+    }
+
+    // Set the number of data scored before each preemption
+    void SetParamBlockSize(int size = 100) { paramBlockSize = size; }
+
+    int GetParamBlockSize(void) { return paramBlockSize; }
+
+    // Set the wall-clock time budget in seconds (0: no time budget)
+    // - Hypotheses are generated during at most half of the budget, and scoring stops at the first block after the budget.
+    void SetParamTimeBudget(double budget = 0) { paramTimeBudget = budget; }
+
+    double GetParamTimeBudget(void) { return paramTimeBudget; }
+
+protected:
+    using RANSAC<Model, Datum, Data>::toolEstimator;
+    using RANSAC<Model, Datum, Data>::toolGenerators;
+    using RANSAC<Model, Datum, Data>::paramIteration;
+    using RANSAC<Model, Datum, Data>::paramThreshold;
+    using RANSAC<Model, Datum, Data>::dataInlierRatio;
+    using RANSAC<Model, Datum, Data>::dataIteration;
+    using RANSAC<Model, Datum, Data>::dataOrder;
+
+    // Calculate the loss of a datum (the truncated quadratic loss of MSAC)
+    virtual double ComputeLoss(double error)
+    {
+        if (error > paramThreshold || error < -paramThreshold) return paramThreshold * paramThreshold;
+        return error * error;
+    }
+
+    int paramBlockSize;
+
+    double paramTimeBudget;
+};
+
+} // End of 'RTL'
+
+#endif // End of '__RTL_PREEMPTIVE_RANSAC__'
@@ -2,9 +2,23 @@
 #define __RTL_RANSAC__
 
 #include "Base.hpp"
-#include <random>
+#include "SPRT.hpp"
+#include "Sampler.hpp"
+#include "Statistics.hpp"
+#include "Location.hpp"
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <unordered_set>
+
+#ifdef _OPENMP
+#   include <omp.h>
+#endif
 
 namespace RTL
 {
@@ -18,19 +32,56 @@ public:
         assert(estimator != NULL);
 
         toolEstimator = estimator;
+        dataIndex = NULL;
+        dataExhaustive = false;
+        dataBounds.assign(1, HUGE_VAL);
+        SetSampler();
+        SetStatisticsCallback();
         SetParamIteration();
+        SetParamIterationMin();
+        SetParamConfidence();
         SetParamThreshold();
+        SetParamThreadNum();
+        SetParamEvalThreadNum();
+        SetParamEvalBlockSize();
+        SetParamSeed();
+        SetParamSPRT();
+        SetParamSPRTEpsilon();
+        SetParamSPRTDelta();
+        SetParamSPRTTimeModel();
+        SetParamLocalOptimization();
+        SetParamLocalThresholdScale();
+        SetParamDegeneracyRedraw();
+        SetParamDeduplication();
+        SetParamExactLocation();
+    }
+
+    virtual ~RANSAC()
+    {
+        for (size_t t = 0; t < toolAccumulators.size(); t++) delete toolAccumulators[t];
     }
 
     virtual double FindBest(Model& best, const Data& data, int N, int M)
     {
         assert(N > 0 && M > 0);
 
+        RTL_STAT(long long timeBegin = Statistics::GetTime());
+        paramSampleSize = M;
         Initialize(data, N);
 
         // Run RANSAC
         double bestloss = HUGE_VAL;
         int iteration = 0;
+        if (paramExactLocation && FindBestLocation(best, bestloss, data, N))
+        {
+            UpdateRequiredIteration(best, data, N);
+            goto RANSAC_FIND_BEST_EXIT;
+        }
+        if (toolGenerators.size() > 1)
+        {
+            FindBestParallel(best, bestloss, iteration, data, N, M);
+            goto RANSAC_FIND_BEST_EXIT;
+        }
         while (IsContinued(iteration))
         {
             iteration++;
@@ -39,58 +90,329 @@ public:
             Model model = GenerateModel(data, M);
 
             // 2. Evaluate the hypotheses
-            double loss = EvaluateModel(model, data, N);
+            RTL_STAT(long long tic = Statistics::GetTime());
+            double loss = EvaluateModelBounded(model, data, N, bestloss);
+            RTL_STAT(statTimeEvaluate += Statistics::GetTime() - tic);
+            RTL_STAT(if (loss > bestloss) dataStatistics.worseNum++);
             if (loss < bestloss)
-                if (!UpdateBest(best, bestloss, model, loss))
+            {
+                RTL_STAT(dataStatistics.updateIterations.push_back(iteration));
+                if (!AcceptBest(best, bestloss, model, loss, data, N))
                     goto RANSAC_FIND_BEST_EXIT;
+            }
         }
 
 RANSAC_FIND_BEST_EXIT:
+        if (bestloss >= HUGE_VAL) AcceptFallback(best, bestloss, data, N);
+        dataIteration = iteration;
         Terminate(best, data, N);
+        RTL_STAT(ReportStatistics(timeBegin));
         return bestloss;
     }
 
+    // Find models one by one, removing inliers of each model from the data for the next one (sequential RANSAC)
+    // - It stops when 'modelMax' models are found (0: no limit) or the best model has less than 'supportMin' inliers.
+    // - The remaining data are kept as a compacted list of their indices, so data are not copied. Hypotheses are drawn
+    //   from and evaluated on the remaining data, where 'N' and indices seen by a sampler are positions in the list.
+    // - 'inliers' has the indices of inliers (in 'data') of each model, and the number of models is returned.
+    int FindMultiple(std::vector<Model>& models, std::vector<std::vector<int> >& inliers, const Data& data, int N, int M, int modelMax, int supportMin)
+    {
+        assert(N > 0 && M > 0);
+
+        models.clear();
+        inliers.clear();
+        std::vector<int> remains(N);
+        for (int i = 0; i < N; i++) remains[i] = i;
+        while (modelMax <= 0 || static_cast<int>(models.size()) < modelMax)
+        {
+            const int n = static_cast<int>(remains.size());
+            if (n < M || n < supportMin) break;
+
+            // Find the best model of the remaining data
+            dataIndex = &remains[0];
+            Model model;
+            double loss = FindBest(model, data, n, M);
+            if (loss >= HUGE_VAL) break;
+            std::vector<int> found = FindInliers(model, data, n);
+            dataIndex = NULL;
+            if (static_cast<int>(found.size()) < supportMin || found.empty()) break;
+
+            // Remove its inliers from the remaining data (both are in the ascending order)
+            int k = 0, kept = 0;
+            for (int i = 0; i < n; i++)
+            {
+                if (k < static_cast<int>(found.size()) && remains[i] == found[k]) k++;
+                else remains[kept++] = remains[i];
+            }
+            remains.resize(kept);
+            models.push_back(model);
+            inliers.push_back(std::vector<int>());
+            inliers.back().swap(found);
+        }
+        dataIndex = NULL;
+        return static_cast<int>(models.size());
+    }
+
     virtual std::vector<int> FindInliers(const Model& model, const Data& data, int N)
     {
+        const int threadNum = GetEvalThreadNum(N);
+        std::vector<std::vector<int> > partInliers(threadNum);
+        RunBlocks(N, threadNum, [&](int t, int begin, int end)
+        {
+            double errors[BATCH_SIZE];
+            for (int i = begin; i < end; i += BATCH_SIZE)
+            {
+                const int size = GetBatchSize(i, end);
+                ComputeErrors(model, data, i, i + size, errors);
+                for (int k = 0; k < size; k++)
+                    if (fabs(errors[k]) < paramThreshold) partInliers[t].push_back(GetIndex(i + k));
+            }
+        });
+
+        // Concatenate inliers of each block
         std::vector<int> inliers;
-        for (int i = 0; i < N; i++)
+        inliers.swap(partInliers[0]);
+        for (int t = 1; t < threadNum; t++)
+            inliers.insert(inliers.end(), partInliers[t].begin(), partInliers[t].end());
+        return inliers;
+    }
+
+    // Write inliers of the given model to a binary file instead of memory, and return their number (-1: failure)
+    // - It writes indices of inliers as 'int64_t', or a bitmask of all data with 'bitmask' (the 'i'-th datum is bit 'i % 8' of byte 'i / 8').
+    // - Data are scanned in order and written in batches, so memory does not grow with the number of data (e.g. 'MappedArray').
+    long long WriteInliers(const Model& model, const Data& data, int N, const char* path, bool bitmask = false)
+    {
+        FILE* file = fopen(path, "wb");
+        if (file == NULL) return -1;
+        long long count = WriteInliers(model, data, N, file, bitmask);
+        if (fclose(file) != 0) count = -1;
+        return count;
+    }
+
+    // Write inliers of the given model to an opened file, where their indices are shifted by 'offset'
+    // - Data more than 'int' can be written chunk by chunk with their offsets (see 'WriteMappedInliers').
+    //   With 'bitmask', chunks except the last one should have multiples of 8 data to keep bits contiguous.
+    long long WriteInliers(const Model& model, const Data& data, int N, FILE* file, bool bitmask, long long offset = 0)
+    {
+        if (file == NULL) return -1;
+        double errors[BATCH_SIZE];
+        int64_t indices[BATCH_SIZE];
+        unsigned char bits[BATCH_SIZE / 8];
+        long long count = 0;
+        bool success = true;
+        for (int i = 0; i < N && success; i += BATCH_SIZE)
         {
-            double error = toolEstimator->ComputeError(model, data[i]);
-            if (fabs(error) < paramThreshold) inliers.push_back(i);
+            const int size = GetBatchSize(i, N);
+            ComputeErrors(model, data, i, i + size, errors);
+            if (bitmask)
+            {
+                const size_t bytes = (size + 7) / 8;
+                memset(bits, 0, bytes);
+                for (int k = 0; k < size; k++)
+                {
+                    if (fabs(errors[k]) >= paramThreshold) continue;
+                    bits[k / 8] |= static_cast<unsigned char>(1 << (k % 8));
+                    count++;
+                }
+                success = (fwrite(bits, 1, bytes, file) == bytes);
+            }
+            else
+            {
+                size_t inlierNum = 0;
+                for (int k = 0; k < size; k++)
+                    if (fabs(errors[k]) < paramThreshold) indices[inlierNum++] = offset + GetIndex(i + k);
+                count += static_cast<long long>(inlierNum);
+                success = (fwrite(indices, sizeof(int64_t), inlierNum, file) == inlierNum);
+            }
         }
-        return inliers;
+        return success ? count : -1;
     }
 
     void SetParamIteration(int iteration = 100) { paramIteration = iteration; }
 
     int GetParamIteration(void) { return paramIteration; }
 
+    // Set the minimum number of iterations which are performed regardless of the confidence
+    void SetParamIterationMin(int iteration = 0) { paramIterationMin = iteration; }
+
+    int GetParamIterationMin(void) { return paramIterationMin; }
+
+    // Set the probability to draw at least one all-inlier sample (0: no adaptive termination)
+    // - The number of iterations is adjusted from the inlier ratio of the best model, and 'paramIteration' is its maximum.
+    void SetParamConfidence(double confidence = 0) { paramConfidence = confidence; }
+
+    double GetParamConfidence(void) { return paramConfidence; }
+
     void SetParamThreshold(double threshold = 1) { paramThreshold = threshold; }
 
-    int GetParamThreshold(void) { return paramThreshold; }
+    double GetParamThreshold(void) { return paramThreshold; }
+
+    // Set the number of threads which generate and evaluate hypotheses in parallel (0: all available threads)
+    // - The estimator is shared by all threads, so its 'ComputeModel' and 'ComputeError' should be thread-safe.
+    void SetParamThreadNum(int thread = 1) { paramThreadNum = thread; }
+
+    int GetParamThreadNum(void) { return paramThreadNum; }
+
+    // Set the seed of random number generators (thread 't' uses the 't'-th jumped stream of the seed)
+    // - The streams are restarted by every 'FindBest', so it returns the same model for the same seed and thread number.
+    void SetParamSeed(unsigned int seed = 5489) { paramSeed = seed; }
+
+    unsigned int GetParamSeed(void) { return paramSeed; }
+
+    // Set the sampler which selects sample indices (NULL: uniform sampling)
+    // - The sampler is shared by all threads, so its 'Draw' should be thread-safe.
+    void SetSampler(Sampler<Data>* sampler = NULL) { toolSampler = sampler; }
+
+    Sampler<Data>* GetSampler(void) { return (toolSampler != NULL) ? toolSampler : &toolUniformSampler; }
+
+    // Set the number of threads which evaluate a hypothesis in parallel by splitting data (0: all available threads)
+    // - It is used only when hypotheses are searched by a single thread.
+    void SetParamEvalThreadNum(int thread = 1) { paramEvalThreadNum = thread; }
+
+    int GetParamEvalThreadNum(void) { return paramEvalThreadNum; }
+
+    // Set the minimum number of data assigned to each evaluation thread
+    void SetParamEvalBlockSize(int size = 10000) { paramEvalBlockSize = size; }
+
+    int GetParamEvalBlockSize(void) { return paramEvalBlockSize; }
+
+    // Set whether hypotheses are verified by Wald's sequential probability ratio test (SPRT)
+    // - Data are checked in a random order, and a hypothesis is rejected as soon as it is likely to be bad.
+    // - The verification is sequential, so it is not split by 'paramEvalThreadNum'.
+    // - If all hypotheses are rejected, the one which was verified on the most data is evaluated fully and returned.
+    // - It is used by RANSAC and MSAC, and ignored by LMedS and MLESAC, whose losses are not tested datum by datum.
+    void SetParamSPRT(bool use = false) { paramSPRT = use; }
+
+    bool GetParamSPRT(void) { return paramSPRT; }
+
+    // Set the initial probability that a datum is consistent with a good model
+    void SetParamSPRTEpsilon(double epsilon = 0.1) { paramSPRTEpsilon = epsilon; }
+
+    double GetParamSPRTEpsilon(void) { return paramSPRTEpsilon; }
+
+    // Set the initial probability that a datum is consistent with a bad model
+    void SetParamSPRTDelta(double delta = 0.01) { paramSPRTDelta = delta; }
+
+    double GetParamSPRTDelta(void) { return paramSPRTDelta; }
+
+    // Set the time to generate a hypothesis relative to the time to verify a datum
+    void SetParamSPRTTimeModel(double time = 200) { paramSPRTTimeModel = time; }
+
+    double GetParamSPRTTimeModel(void) { return paramSPRTTimeModel; }
+
+    // Set the number of refits of local optimization for each new best model (0: no local optimization)
+    // - Ref. K. Lebeda et al., Fixing the Locally Optimized RANSAC, BMVC, 2012
+    // - The best model is refitted to its inliers while the loss improves. If the estimator provides an 'Accumulator',
+    //   each refit only adds and removes data whose inlier status changed.
+    void SetParamLocalOptimization(int iteration = 0) { paramLocalIteration = iteration; }
+
+    int GetParamLocalOptimization(void) { return paramLocalIteration; }
+
+    // Set the inlier threshold of the first refit relative to 'paramThreshold' (it shrinks to 'paramThreshold' at the last refit)
+    void SetParamLocalThresholdScale(double scale = 1) { paramLocalThresholdScale = scale; }
+
+    double GetParamLocalThresholdScale(void) { return paramLocalThresholdScale; }
+
+    // Set the maximum number of redraws of invalid samples or models for each hypothesis
+    // - Validity is checked by 'Estimator::IsSampleValid' and 'Estimator::IsModelValid'.
+    //   After the last redraw, the hypothesis is evaluated even if it is invalid.
+    void SetParamDegeneracyRedraw(int count = 100) { paramDegeneracyRedraw = count; }
+
+    int GetParamDegeneracyRedraw(void) { return paramDegeneracyRedraw; }
+
+    // Set whether a sample which was already drawn is redrawn without computing and evaluating its model
+    // - Drawn samples are kept in a hash set of their sorted indices, and a repeated one is redrawn as an invalid sample.
+    // - If all C(N, M) samples are not more than 'paramIteration', they are enumerated exhaustively and the search stops after them.
+    void SetParamDeduplication(bool use = false) { paramDeduplication = use; }
+
+    bool GetParamDeduplication(void) { return paramDeduplication; }
+
+    // Set whether 1-D location models are found exactly by 'LocationSolver' without sampling (only for RANSAC and MSAC)
+    // - It is used only if the estimator supports 'Estimator::GetLocation', and 'FindBest' performs no iteration.
+    void SetParamExactLocation(bool use = true) { paramExactLocation = use; }
+
+    bool GetParamExactLocation(void) { return paramExactLocation; }
+
+    // Get the inlier ratio of the best model which was estimated for adaptive termination by the last 'FindBest'
+    // - It is counted only with 'paramConfidence > 0' (0 otherwise), and 'PreemptiveRANSAC' counts it on the scored data.
+    // - 'FindInliers' gives the exact inliers of any model without the cost of counting them in every 'FindBest'.
+    double GetEstimatedInlierRatio(void) { return dataInlierRatio; }
+
+    // Get the number of iterations performed by the last 'FindBest'
+    int GetIterationCount(void) { return dataIteration; }
+
+    // Get statistics of the last 'FindBest' (only if 'RTL_ENABLE_STATISTICS' is defined)
+    const Statistics& GetStatistics(void) { return dataStatistics; }
+
+    // Set the function which receives statistics at the end of each 'FindBest' (only if 'RTL_ENABLE_STATISTICS' is defined)
+    void SetStatisticsCallback(std::function<void(const Statistics&)> callback = nullptr) { toolStatisticsCallback = callback; }
 
 protected:
-    virtual bool IsContinued(int iteration) { return (iteration < paramIteration); }
+    virtual bool IsContinued(int iteration)
+    {
+        if (dataExhaustive && (iteration >= dataCombinationNum || dataCombinationDone)) return false;
+        if (iteration < paramIterationMin) return true;
+        return (iteration < paramIteration) && (iteration < dataIterationRequired);
+    }
+
+    // Find the globally optimal 1-D location model with the RANSAC loss (false: not supported)
+    virtual bool FindBestLocation(Model& best, double& bestloss, const Data& data, int N)
+    {
+        std::vector<double> values;
+        if (!GetLocations(values, data, N)) return false;
+        double location = 0;
+        bestloss = LocationSolver<Model, Datum, Data>::FindRANSAC(values, paramThreshold, location);
+        best = toolEstimator->GetLocationModel(location);
+        return true;
+    }
 
     virtual Model GenerateModel(const Data& data, int M)
     {
-        std::set<int> samples;
-        while (static_cast<int>(samples.size()) < M)
-            samples.insert(toolUniform(toolGenerator));
-        return toolEstimator->ComputeModel(data, samples);
+        const int thread = GetThreadIndex();
+        Sampler<Data>* sampler = GetSampler();
+        Xoshiro256& generator = toolGenerators[thread];
+        return GenerateValidModel(data, &dataSamples[thread * M], M, [sampler, &generator](int* samples, int M) { sampler->Draw(samples, M, generator); });
     }
 
+    // Calculate the loss of the given model
+    // - If the loss is going to be larger than 'GetEvaluationBound()', evaluation can be stopped with any value larger than it.
     virtual double EvaluateModel(const Model& model, const Data& data, int N)
     {
-        double loss = 0;
-        for (int i = 0; i < N; i++)
+        const double bound = GetEvaluationBound();
+        if (paramSPRT)
         {
-            double error = toolEstimator->ComputeError(model, data[i]);
-            loss += (fabs(error) > paramThreshold);
+            const double threshold = paramThreshold;
+            return EvaluateModelSPRT(model, data, N, bound, [threshold](double error) { return static_cast<double>(fabs(error) > threshold); });
         }
+
+        return SumBlocks(N, GetEvalThreadNum(N), [&](int begin, int end)
+        {
+            double loss = 0, errors[BATCH_SIZE];
+            for (int i = begin; i < end && loss <= bound; i += BATCH_SIZE) // A partial loss is enough to reject
+            {
+                const int size = GetBatchSize(i, end);
+                ComputeErrors(model, data, i, i + size, errors);
+                for (int k = 0; k < size; k++)
+                    loss += (fabs(errors[k]) > paramThreshold);
+            }
+            return loss;
+        });
+    }
+
+    // Calculate the loss of the given model by 'EvaluateModel', which can be stopped once it is larger than 'bound'
+    double EvaluateModelBounded(const Model& model, const Data& data, int N, double bound)
+    {
+        double& current = dataBounds[GetThreadIndex()];
+        const double previous = current;
+        current = bound;
+        const double loss = EvaluateModel(model, data, N);
+        current = previous;
         return loss;
     }
 
+    // Get the loss which the current evaluation of the thread needs to beat (HUGE_VAL: no bound)
+    double GetEvaluationBound(void) { return dataBounds[GetThreadIndex()]; }
+
     virtual bool UpdateBest(Model& bestModel, double& bestCost, const Model& model, double cost)
     {
         bestModel = model;
@@ -98,21 +420,579 @@ protected:
         return true;
     }
 
-    virtual void Initialize(const Data& data, int N) { toolUniform = std::uniform_int_distribution<int>(0, N - 1); }
+    virtual void Initialize(const Data& data, int N)
+    {
+        dataInlierRatio = 0;
+        dataIteration = 0;
+        dataIterationRequired = paramIteration;
+        dataStatistics.Clear();
+        RTL_STAT(statPointNum = 0);
+        RTL_STAT(statDegenerateNum = 0);
+        RTL_STAT(statDuplicateNum = 0);
+        RTL_STAT(statTimeSample = 0);
+        RTL_STAT(statTimeModel = 0);
+        RTL_STAT(statTimeEvaluate = 0);
+
+        // Prepare a random order of data and the test for SPRT
+        if (paramSPRT)
+        {
+            dataOrder.resize(N);
+            for (int i = 0; i < N; i++) dataOrder[i] = i;
+            Xoshiro256 generator(paramSeed);
+            std::shuffle(dataOrder.begin(), dataOrder.end(), generator);
+            dataSPRT.Reset(paramSPRTEpsilon, paramSPRTDelta, paramSPRTTimeModel);
+        }
+        dataFallbackLength = 0;
+
+        // Prepare a random number generator for each thread (on its own stream)
+        int threadNum = 1;
+#ifdef _OPENMP
+        threadNum = (paramThreadNum > 0) ? paramThreadNum : omp_get_max_threads();
+#endif
+        toolGenerators.assign(threadNum, Xoshiro256(paramSeed));
+        for (int t = 1; t < threadNum; t++)
+        {
+            toolGenerators[t] = toolGenerators[t - 1];
+            toolGenerators[t].Jump();
+        }
+        dataSamples.resize(threadNum * paramSampleSize);
+        dataBounds.assign(threadNum, HUGE_VAL);
+
+        // Prepare workspaces of local optimization for each thread (reused by all refits)
+        if (paramLocalIteration > 0)
+        {
+            while (static_cast<int>(toolAccumulators.size()) < threadNum) toolAccumulators.push_back(toolEstimator->CreateAccumulator());
+            dataLocalMasks.resize(threadNum);
+            dataLocalInliers.resize(threadNum);
+            for (int t = 0; t < threadNum; t++) dataLocalMasks[t].resize(N);
+        }
+
+        // Prepare deduplication or exhaustive enumeration
+        dataDrawn.clear();
+        dataCombinationNum = GetCombinationNum(N, paramSampleSize, paramIteration);
+        dataExhaustive = paramDeduplication && (dataCombinationNum <= paramIteration);
+        dataCombinationDone = false;
+        dataCombination.resize(paramSampleSize);
+        for (int m = 0; m < paramSampleSize; m++) dataCombination[m] = m;
+        dataCombinationLimit = N;
+        GetSampler()->SetIndex(dataIndex);
+        GetSampler()->Initialize(data, N);
+    }
 
     virtual void Terminate(const Model& bestModel, const Data& data, int N) { }
 
-    std::mt19937 toolGenerator;
+    // Run hypothesis generation and evaluation on multiple threads
+    // - Hypotheses are processed in rounds. In each round, iteration 'i' is always assigned to thread 'i % threadNum',
+    //   and only the best hypothesis of the round is passed to 'UpdateBest', so the result is reproducible.
+    // - The best loss is published to all threads so that they can stop evaluating hypotheses which cannot win.
+    void FindBestParallel(Model& best, double& bestloss, int& iteration, const Data& data, int N, int M)
+    {
+#ifdef _OPENMP
+        const int threadNum = static_cast<int>(toolGenerators.size());
+        const int roundMax = 4 * threadNum;
+        std::vector<Model> models(roundMax);
+        std::vector<double> losses(roundMax);
+        std::atomic<double> sharedLoss(bestloss);
+
+        while (IsContinued(iteration))
+        {
+            int round = 1;
+            while (round < roundMax && IsContinued(iteration + round)) round++;
+
+#pragma omp parallel for num_threads(threadNum) schedule(static, 1)
+            for (int i = 0; i < round; i++)
+            {
+                // 1. Generate hypotheses
+                models[i] = GenerateModel(data, M);
+
+                // 2. Evaluate the hypotheses
+                RTL_STAT(long long tic = Statistics::GetTime());
+                losses[i] = EvaluateModelBounded(models[i], data, N, sharedLoss.load());
+                RTL_STAT(statTimeEvaluate += Statistics::GetTime() - tic);
+                double shared = sharedLoss.load();
+                while (losses[i] < shared && !sharedLoss.compare_exchange_weak(shared, losses[i])) { }
+            }
+
+            // Update the best hypothesis of this round
+            // - A stopped evaluation returns a loss larger than another hypothesis, so it is never selected.
+            int roundBest = 0;
+            for (int i = 1; i < round; i++)
+                if (losses[i] < losses[roundBest]) roundBest = i;
+            RTL_STAT(for (int i = 0; i < round; i++) dataStatistics.worseNum += (losses[i] > bestloss));
+            iteration += round;
+            if (losses[roundBest] < bestloss)
+            {
+                RTL_STAT(dataStatistics.updateIterations.push_back(iteration - round + roundBest + 1));
+                if (!AcceptBest(best, bestloss, models[roundBest], losses[roundBest], data, N))
+                    return;
+            }
+            sharedLoss = bestloss;
+        }
+#endif
+    }
+
+    // Draw samples by 'draw(samples, M)' and compute a model until both are valid (at most 'paramDegeneracyRedraw' redraws)
+    template <class DrawFunction>
+    Model GenerateValidModel(const Data& data, int* samples, int M, DrawFunction draw)
+    {
+        Model model;
+        for (int redraw = 0; ; redraw++)
+        {
+            RTL_STAT(long long tic = Statistics::GetTime());
+            if (dataExhaustive) NextCombination(samples, M);
+            else draw(samples, M);
+            const bool last = (redraw >= paramDegeneracyRedraw);
+            const bool duplicate = !last && paramDeduplication && !dataExhaustive && IsDrawn(samples, M);
+            MapSamples(samples, M);
+            RTL_STAT(long long toc = Statistics::GetTime());
+            RTL_STAT(statTimeSample += toc - tic);
+            if (duplicate)
+            {
+                RTL_STAT(statDuplicateNum++);
+                continue;
+            }
+            if (!last && !toolEstimator->IsSampleValid(data, samples, M))
+            {
+                RTL_STAT(statDegenerateNum++);
+                continue;
+            }
+            model = toolEstimator->ComputeModel(data, samples, M);
+            RTL_STAT(statTimeModel += Statistics::GetTime() - toc);
+            if (last || toolEstimator->IsModelValid(model)) break;
+            RTL_STAT(statDegenerateNum++);
+        }
+        return model;
+    }
+
+    // Get 1-D locations of data (false: not supported by the estimator)
+    bool GetLocations(std::vector<double>& values, const Data& data, int N)
+    {
+        values.resize(N);
+        for (int i = 0; i < N; i++)
+            if (!toolEstimator->GetLocation(data[GetIndex(i)], values[i])) return false;
+        return true;
+    }
+
+    // Check whether the same sample was already drawn, and remember it if not
+    bool IsDrawn(const int* samples, int M)
+    {
+        // Hash the sorted indices (a rare collision only redraws a new sample)
+        int sorted[64];
+        const int K = std::min(M, 64);
+        std::copy(samples, samples + K, sorted);
+        std::sort(sorted, sorted + K);
+        uint64_t key = static_cast<uint64_t>(M);
+        for (int k = 0; k < K; k++)
+        {
+            key ^= static_cast<uint64_t>(sorted[k]) + 0x9e3779b97f4a7c15ULL + (key << 6) + (key >> 2);
+            key = (key ^ (key >> 31)) * 0xbf58476d1ce4e5b9ULL;
+        }
+        bool drawn;
+#pragma omp critical(RTL_DEDUPLICATION)
+        drawn = !dataDrawn.insert(key).second;
+        return drawn;
+    }
+
+    // Get the next sample of exhaustive enumeration in the lexicographic order (the last one is repeated after all)
+    void NextCombination(int* samples, int M)
+    {
+#pragma omp critical(RTL_DEDUPLICATION)
+        {
+            std::copy(dataCombination.begin(), dataCombination.end(), samples);
+            int m = M - 1;
+            while (m >= 0 && dataCombination[m] == dataCombinationLimit - M + m) m--;
+            if (m < 0) dataCombinationDone = true;
+            else
+            {
+                dataCombination[m]++;
+                for (int k = m + 1; k < M; k++) dataCombination[k] = dataCombination[k - 1] + 1;
+            }
+        }
+    }
+
+    // Get C(N, M), or 'limit + 1' if it is larger than 'limit'
+    static int GetCombinationNum(int N, int M, int limit)
+    {
+        if (M > N) return 0;
+        double count = 1;
+        for (int m = 0; m < M; m++)
+        {
+            count = count * (N - m) / (m + 1);
+            if (count > limit) return limit + 1;
+        }
+        return static_cast<int>(count + 0.5);
+    }
+
+    // Accept a new best model with local optimization and update the number of required iterations
+    // - It returns false if the search should be stopped.
+    bool AcceptBest(Model& best, double& bestloss, const Model& model, double loss, const Data& data, int N)
+    {
+        if (!UpdateBest(best, bestloss, model, loss)) return false;
+        if (paramLocalIteration > 0)
+        {
+            Model refined = best;
+            double refinedLoss = LocalOptimize(refined, bestloss, data, N);
+            if (refinedLoss < bestloss && !UpdateBest(best, bestloss, refined, refinedLoss)) return false;
+        }
+        UpdateRequiredIteration(best, data, N);
+        return true;
+    }
+
+    // Refit 'model' to its inliers repeatedly and return the loss of the refined 'model'
+    double LocalOptimize(Model& model, double loss, const Data& data, int N)
+    {
+        const int M = paramSampleSize;
+        const int thread = GetThreadIndex();
+        Accumulator<Model, Datum>* accumulator = toolAccumulators[thread];
+        std::vector<char>& isInlier = dataLocalMasks[thread];
+        std::vector<int>& inliers = dataLocalInliers[thread];
+        if (accumulator != NULL) accumulator->Clear();
+        std::fill(isInlier.begin(), isInlier.end(), 0);
+        double errors[BATCH_SIZE];
+        for (int k = 0; k < paramLocalIteration; k++)
+        {
+            // Find inliers with the shrinking threshold
+            double scale = paramLocalThresholdScale;
+            if (paramLocalIteration > 1) scale += (1 - paramLocalThresholdScale) * k / (paramLocalIteration - 1);
+            const double threshold = scale * paramThreshold;
+            inliers.clear();
+            for (int i = 0; i < N; i += BATCH_SIZE)
+            {
+                const int size = GetBatchSize(i, N);
+                ComputeErrors(model, data, i, i + size, errors);
+                for (int j = 0; j < size; j++)
+                {
+                    const char in = (fabs(errors[j]) < threshold);
+                    if (accumulator == NULL)
+                    {
+                        if (in) inliers.push_back(GetIndex(i + j));
+                    }
+                    else if (in != isInlier[i + j])
+                    {
+                        if (in) accumulator->Add(data[GetIndex(i + j)]);
+                        else accumulator->Remove(data[GetIndex(i + j)]);
+                        isInlier[i + j] = in;
+                    }
+                }
+            }
+
+            // Refit the model and keep it if its loss is improved
+            const int inlierNum = (accumulator == NULL) ? static_cast<int>(inliers.size()) : accumulator->GetCount();
+            if (inlierNum <= M) break;
+            Model candidate = (accumulator == NULL) ? toolEstimator->ComputeModel(data, &inliers[0], inlierNum) : accumulator->ComputeModel();
+            double candidateLoss = EvaluateModelBounded(candidate, data, N, loss);
+            if (candidateLoss >= loss) break;
+            model = candidate;
+            loss = candidateLoss;
+        }
+        return loss;
+    }
+
+    // Update the number of iterations to draw at least one all-inlier sample with 'paramConfidence'
+    // - Ref. M. A. Fischler and R. C. Bolles, Random Sample Consensus, Communications of the ACM, 1981
+    void UpdateRequiredIteration(const Model& bestModel, const Data& data, int N)
+    {
+        if (paramConfidence <= 0) return;
+
+        dataInlierRatio = static_cast<double>(CountInliers(bestModel, data, N)) / N;
+        double probAllInlier = pow(dataInlierRatio, paramSampleSize);
+        if (paramSPRT)
+        {
+            // A good model can be rejected by SPRT, so it is also considered.
+            SPRT test;
+#pragma omp critical(RTL_SPRT)
+            test = dataSPRT;
+            probAllInlier *= test.GetProbAccept();
+        }
+        if (probAllInlier >= 1) dataIterationRequired = 0;
+        else if (probAllInlier > 0)
+        {
+            double required = log(1 - paramConfidence) / log(1 - probAllInlier);
+            if (required < dataIterationRequired) dataIterationRequired = static_cast<int>(ceil(required));
+        }
+    }
+
+    // Evaluate the given model with SPRT while accumulating 'lossFunc' of each error
+    // - A rejected model returns 'HUGE_VAL', and the test is adapted with rejected and accepted models.
+    template <class LossFunction>
+    double EvaluateModelSPRT(const Model& model, const Data& data, int N, double bound, LossFunction lossFunc)
+    {
+        SPRT test;
+#pragma omp critical(RTL_SPRT)
+        test = dataSPRT;
+
+        const double ratioConsistent = test.GetRatioConsistent(), ratioInconsistent = test.GetRatioInconsistent();
+        const double threshold = test.GetThreshold();
+        double lambda = 1, loss = 0;
+        int consistent = 0;
+        for (int j = 0; j < N; j++)
+        {
+            double error = toolEstimator->ComputeError(model, data[GetIndex(dataOrder[j])]);
+            if (fabs(error) > paramThreshold) lambda *= ratioInconsistent;
+            else
+            {
+                lambda *= ratioConsistent;
+                consistent++;
+            }
+            loss += lossFunc(error);
+            if (lambda > threshold)
+            {
+#pragma omp critical(RTL_SPRT)
+                {
+                    dataSPRT.AddRejected(j + 1, consistent);
+                    if (j + 1 > dataFallbackLength)
+                    {
+                        dataFallback = model;
+                        dataFallbackLength = j + 1;
+                    }
+                }
+                RTL_STAT(statPointNum += j + 1);
+                return HUGE_VAL;
+            }
+            if (loss > bound)
+            {
+                RTL_STAT(statPointNum += j + 1);
+                return loss;
+            }
+        }
+        RTL_STAT(statPointNum += N);
+
+#pragma omp critical(RTL_SPRT)
+        dataSPRT.UpdateEpsilon(static_cast<double>(consistent) / N);
+        return loss;
+    }
+
+    // Accept the rejected hypothesis which was verified on the most data if SPRT rejected all hypotheses
+    // - It is evaluated (and refined) without SPRT, so its loss is on all data.
+    void AcceptFallback(Model& best, double& bestloss, const Data& data, int N)
+    {
+        if (!paramSPRT || dataFallbackLength <= 0) return;
+        paramSPRT = false;
+        const double loss = EvaluateModelBounded(dataFallback, data, N, HUGE_VAL);
+        AcceptBest(best, bestloss, dataFallback, loss, data, N);
+        paramSPRT = true;
+    }
+
+    // Count the number of inliers of the given model
+    int CountInliers(const Model& model, const Data& data, int N)
+    {
+        double count = SumBlocks(N, GetEvalThreadNum(N), [&](int begin, int end)
+        {
+            double count = 0, errors[BATCH_SIZE];
+            for (int i = begin; i < end; i += BATCH_SIZE)
+            {
+                const int size = GetBatchSize(i, end);
+                ComputeErrors(model, data, i, i + size, errors);
+                for (int k = 0; k < size; k++)
+                    count += (fabs(errors[k]) < paramThreshold);
+            }
+            return count;
+        });
+        return static_cast<int>(count);
+    }
+
+    // Calculate errors of data from 'begin' to 'end - 1' into 'errors'
+    void ComputeErrors(const Model& model, const Data& data, int begin, int end, double* errors)
+    {
+        RTL_STAT(statPointNum.fetch_add(end - begin, std::memory_order_relaxed));
+        if (dataIndex != NULL) toolEstimator->ComputeIndexedErrors(model, data, dataIndex + begin, end - begin, errors);
+        else toolEstimator->ComputeErrors(model, data, begin, end, errors);
+    }
+
+    // Get the index (in 'data') of the 'i'-th datum, which differs only if data are accessed through 'dataIndex'
+    int GetIndex(int i) { return (dataIndex != NULL) ? dataIndex[i] : i; }
+
+    // Convert positions of samples to their indices in 'data'
+    void MapSamples(int* samples, int M)
+    {
+        if (dataIndex == NULL) return;
+        for (int m = 0; m < M; m++) samples[m] = dataIndex[samples[m]];
+    }
+
+    // Complete statistics of 'FindBest' which began at 'timeBegin' and pass them to the callback
+    void ReportStatistics(long long timeBegin)
+    {
+#ifdef RTL_ENABLE_STATISTICS
+        dataStatistics.iterationNum = dataIteration;
+        dataStatistics.pointNum = statPointNum;
+        dataStatistics.degenerateNum = statDegenerateNum;
+        dataStatistics.duplicateNum = statDuplicateNum;
+        dataStatistics.timeSample = statTimeSample * 1e-9;
+        dataStatistics.timeModel = statTimeModel * 1e-9;
+        dataStatistics.timeEvaluate = statTimeEvaluate * 1e-9;
+        dataStatistics.timeTotal = (Statistics::GetTime() - timeBegin) * 1e-9;
+        if (toolStatisticsCallback) toolStatisticsCallback(dataStatistics);
+#endif
+    }
+
+    // Get the index of the current thread among threads which search hypotheses
+    // - It is always 0 with a single search thread, even if 'FindBest' is called in a parallel region (e.g. 'BatchSolver').
+    int GetThreadIndex(void)
+    {
+#ifdef _OPENMP
+        return (toolGenerators.size() > 1) ? omp_get_thread_num() : 0;
+#else
+        return 0;
+#endif
+    }
+
+    // Get the number of threads to evaluate 'N' data
+    int GetEvalThreadNum(int N)
+    {
+#ifdef _OPENMP
+        if (omp_in_parallel()) return 1;
+        int threadNum = (paramEvalThreadNum > 0) ? paramEvalThreadNum : omp_get_max_threads();
+        int blockNum = (paramEvalBlockSize > 0) ? (N / paramEvalBlockSize) : N;
+        if (threadNum > blockNum) threadNum = blockNum;
+        if (threadNum > 1) return threadNum;
+#endif
+        return 1;
+    }
+
+    // Get the beginning index of the 't'-th block when 'N' data are split into 'blockNum' blocks
+    static int GetBlockBegin(int N, int t, int blockNum) { return static_cast<int>(static_cast<long long>(N) * t / blockNum); }
 
-    std::uniform_int_distribution<int> toolUniform;
+    // Run 'func(t, begin, end)' for each of 'blockNum' blocks of 'N' data
+    // - Blocks are processed in parallel only if there are more than one, which avoids the overhead of a parallel region.
+    template <class BlockFunction>
+    static void RunBlocks(int N, int blockNum, BlockFunction func)
+    {
+        if (blockNum <= 1)
+        {
+            func(0, 0, N);
+            return;
+        }
+#pragma omp parallel for num_threads(blockNum)
+        for (int t = 0; t < blockNum; t++)
+            func(t, GetBlockBegin(N, t, blockNum), GetBlockBegin(N, t + 1, blockNum));
+    }
+
+    // Sum 'func(begin, end)' of each of 'blockNum' blocks of 'N' data
+    template <class BlockFunction>
+    static double SumBlocks(int N, int blockNum, BlockFunction func)
+    {
+        if (blockNum <= 1) return func(0, N);
+        double sum = 0;
+#pragma omp parallel for num_threads(blockNum) reduction(+:sum)
+        for (int t = 0; t < blockNum; t++)
+            sum += func(GetBlockBegin(N, t, blockNum), GetBlockBegin(N, t + 1, blockNum));
+        return sum;
+    }
+
+    // Get the number of data in a batch which starts from 'begin' and ends before 'end'
+    static int GetBatchSize(int begin, int end) { return (end - begin < BATCH_SIZE) ? (end - begin) : BATCH_SIZE; }
+
+    // The number of errors calculated together by 'Estimator::ComputeErrors'
+    static const int BATCH_SIZE = 256;
+
+    std::vector<Xoshiro256> toolGenerators;
+
+    Sampler<Data>* toolSampler;
+
+    UniformSampler<Data> toolUniformSampler;
 
     Estimator<Model, Datum, Data>* toolEstimator;
 
+    // The accumulator of each thread for local optimization (NULL if the estimator does not provide it)
+    std::vector<Accumulator<Model, Datum>*> toolAccumulators;
+
+    std::function<void(const Statistics&)> toolStatisticsCallback;
+
     int paramSampleSize;
 
     int paramIteration;
 
+    int paramIterationMin;
+
+    double paramConfidence;
+
     double paramThreshold;
+
+    int paramThreadNum;
+
+    int paramEvalThreadNum;
+
+    int paramEvalBlockSize;
+
+    unsigned int paramSeed;
+
+    bool paramSPRT;
+
+    double paramSPRTEpsilon;
+
+    double paramSPRTDelta;
+
+    double paramSPRTTimeModel;
+
+    int paramLocalIteration;
+
+    double paramLocalThresholdScale;
+
+    int paramDegeneracyRedraw;
+
+    bool paramDeduplication;
+
+    bool paramExactLocation;
+
+    double dataInlierRatio;
+
+    int dataIteration;
+
+    int dataIterationRequired;
+
+    SPRT dataSPRT;
+
+    // The rejected hypothesis which was verified on the most data by SPRT (and the number of the data)
+    Model dataFallback;
+
+    int dataFallbackLength;
+
+    std::vector<int> dataOrder;
+
+    std::vector<int> dataSamples;
+
+    std::vector<double> dataBounds;
+
+    // The inlier flags and inlier indices of each thread for local optimization
+    std::vector<std::vector<char> > dataLocalMasks;
+
+    std::vector<std::vector<int> > dataLocalInliers;
+
+    Statistics dataStatistics;
+
+    std::unordered_set<uint64_t> dataDrawn;
+
+    bool dataExhaustive;
+
+    bool dataCombinationDone;
+
+    int dataCombinationNum;
+
+    int dataCombinationLimit;
+
+    std::vector<int> dataCombination;
+
+    // The indices of data which are accessed instead of '0' to 'N - 1' (NULL: all data)
+    const int* dataIndex;
+
+#ifdef RTL_ENABLE_STATISTICS
+    std::atomic<long long> statPointNum;
+
+    std::atomic<int> statDegenerateNum;
+
+    std::atomic<int> statDuplicateNum;
+
+    std::atomic<long long> statTimeSample;
+
+    std::atomic<long long> statTimeModel;
+
+    std::atomic<long long> statTimeEvaluate;
+#endif
+
+private:
+    RANSAC(const RANSAC&);
+
+    RANSAC& operator=(const RANSAC&);
 }; // End of 'RANSAC'
 
 } // End of 'RTL'
@@ -2,12 +2,23 @@
 #define __RTL__
 
 #include "Base.hpp"
+#include "SPRT.hpp"
+#include "Sampler.hpp"
+#include "NAPSAC.hpp"
+#include "Statistics.hpp"
 #include "RANSAC.hpp"
 #include "LMedS.hpp"
 #include "MSAC.hpp"
 #include "MLESAC.hpp"
+#include "PreemptiveRANSAC.hpp"
+#include "PROSAC.hpp"
+#include "StaticRANSAC.hpp"
+#include "StreamRANSAC.hpp"
+#include "Batch.hpp"
+#include "Mapped.hpp"
 
 #include "Line.hpp"
+#include "Plane.hpp"
 
 #include "Evaluator.hpp"
 
@@ -0,0 +1,99 @@
+#ifndef __RTL_SPRT__
+#define __RTL_SPRT__
+
+#include <cmath>
+
+namespace RTL
+{
+
+// Wald's sequential probability ratio test (SPRT) for randomized hypothesis verification
+// - Ref. O. Chum and J. Matas, Optimal Randomized RANSAC, IEEE Transactions on PAMI, 2008
+// - 'epsilon' is the probability that a datum is consistent with a good model,
+//   and 'delta' is the probability that a datum is consistent with a bad model.
+class SPRT
+{
+public:
+    SPRT(double _epsilon = 0.1, double _delta = 0.01, double _timeModel = 200) { Reset(_epsilon, _delta, _timeModel); }
+
+    void Reset(double _epsilon, double _delta, double _timeModel)
+    {
+        epsilon = _epsilon;
+        delta = _delta;
+        timeModel = _timeModel;
+        rejectedTested = 0;
+        rejectedConsistent = 0;
+        Design();
+    }
+
+    // Update 'epsilon' with the inlier ratio of an accepted model if it is larger
+    bool UpdateEpsilon(double ratio)
+    {
+        if (ratio <= epsilon) return false;
+        epsilon = ratio;
+        Design();
+        return true;
+    }
+
+    // Update 'delta' with the ratio of consistent data among data tested by rejected models
+    bool AddRejected(int tested, int consistent)
+    {
+        rejectedTested += tested;
+        rejectedConsistent += consistent;
+        double ratio = static_cast<double>(rejectedConsistent) / rejectedTested;
+        if (ratio <= 0 || fabs(ratio - delta) < 0.05 * delta) return false;
+        delta = ratio;
+        Design();
+        return true;
+    }
+
+    // Get the likelihood ratio of a consistent datum
+    double GetRatioConsistent(void) const { return delta / epsilon; }
+
+    // Get the likelihood ratio of an inconsistent datum
+    double GetRatioInconsistent(void) const { return (1 - delta) / (1 - epsilon); }
+
+    // Get the decision threshold of the likelihood ratio
+    double GetThreshold(void) const { return threshold; }
+
+    // Get the probability that a good model is accepted
+    double GetProbAccept(void) const { return 1 - 1 / threshold; }
+
+    double GetEpsilon(void) const { return epsilon; }
+
+    double GetDelta(void) const { return delta; }
+
+protected:
+    // Find the optimal threshold, A = timeModel * C + 1 + log(A), where C is the expected information per datum
+    // - 'timeModel' is the time of a hypothesis in units of verifying a datum (one model per sample).
+    void Design(void)
+    {
+        threshold = HUGE_VAL;
+        if (epsilon >= 1 || delta <= 0 || epsilon <= delta) return;
+
+        double C = (1 - delta) * log((1 - delta) / (1 - epsilon)) + delta * log(delta / epsilon);
+        double K = timeModel * C + 1;
+        threshold = K;
+        for (int i = 0; i < 20; i++)
+        {
+            double prev = threshold;
+            threshold = K + log(prev);
+            if (fabs(threshold - prev) < 1e-6) break;
+        }
+    }
+
+    double epsilon;
+
+    double delta;
+
+    double timeModel;
+
+    double threshold;
+
+    long long rejectedTested;
+
+    long long rejectedConsistent;
+}; // End of 'SPRT'
+
+} // End of 'RTL'
+
+#endif // End of '__RTL_SPRT__'
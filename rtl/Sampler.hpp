@@ -0,0 +1,155 @@
+#ifndef __RTL_SAMPLER__
+#define __RTL_SAMPLER__
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+namespace RTL
+{
+
+// xoshiro256** random number generator with jumps for independent streams
+// - Ref. D. Blackman and S. Vigna, Scrambled Linear Pseudorandom Number Generators, ACM TOMS, 2021
+// - It satisfies 'UniformRandomBitGenerator', so it can be also used with distributions in <random>.
+class Xoshiro256
+{
+public:
+    typedef uint64_t result_type;
+
+    Xoshiro256(uint64_t seed = 5489) { Seed(seed); }
+
+    // Initialize the state from 'seed' using splitmix64
+    void Seed(uint64_t seed)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            seed += 0x9e3779b97f4a7c15ULL;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            state[i] = z ^ (z >> 31);
+        }
+    }
+
+    result_type operator()(void)
+    {
+        const uint64_t result = RotateLeft(state[1] * 5, 7) * 9;
+        const uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = RotateLeft(state[3], 45);
+        return result;
+    }
+
+    // Draw an integer in [0, n) without division in most cases
+    // - Ref. D. Lemire, Fast Random Integer Generation in an Interval, ACM TOMACS, 2019
+    int Uniform(int n)
+    {
+        const uint32_t range = static_cast<uint32_t>(n);
+        uint64_t m = static_cast<uint64_t>(static_cast<uint32_t>((*this)() >> 32)) * range;
+        uint32_t low = static_cast<uint32_t>(m);
+        if (low < range)
+        {
+            const uint32_t threshold = static_cast<uint32_t>(-range) % range;
+            while (low < threshold)
+            {
+                m = static_cast<uint64_t>(static_cast<uint32_t>((*this)() >> 32)) * range;
+                low = static_cast<uint32_t>(m);
+            }
+        }
+        return static_cast<int>(m >> 32);
+    }
+
+    // Advance the state by 2^128 steps, which gives a non-overlapping stream (e.g. for each thread)
+    void Jump(void)
+    {
+        static const uint64_t JUMP[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+        Jump(JUMP);
+    }
+
+    // Advance the state by 2^192 steps, which gives a non-overlapping group of streams (e.g. for each batch job)
+    void LongJump(void)
+    {
+        static const uint64_t LONG_JUMP[] = { 0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL, 0x77710069854ee241ULL, 0x39109bb02acbe635ULL };
+        Jump(LONG_JUMP);
+    }
+
+    static constexpr result_type min(void) { return 0; }
+
+    static constexpr result_type max(void) { return UINT64_MAX; }
+
+protected:
+    static uint64_t RotateLeft(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    void Jump(const uint64_t* polynomial)
+    {
+        uint64_t s[4] = { 0, 0, 0, 0 };
+        for (int i = 0; i < 4; i++)
+        {
+            for (int b = 0; b < 64; b++)
+            {
+                if (polynomial[i] & (1ULL << b))
+                    for (int k = 0; k < 4; k++) s[k] ^= state[k];
+                (*this)();
+            }
+        }
+        for (int k = 0; k < 4; k++) state[k] = s[k];
+    }
+
+    uint64_t state[4];
+}; // End of 'Xoshiro256'
+
+// Draw 'M' distinct indices in [0, N) uniformly using Floyd's algorithm (without any buffer but 'samples')
+inline void DrawUniform(int* samples, int M, int N, Xoshiro256& generator)
+{
+    for (int j = N - M, m = 0; j < N; j++, m++)
+    {
+        int index = generator.Uniform(j + 1);
+        if (std::find(samples, samples + m, index) != samples + m) index = j;
+        samples[m] = index;
+    }
+}
+
+// An interface of sample selection
+// - 'Draw' can be called by multiple threads at the same time with their own generators,
+//   so it should not modify the sampler. Data-dependent preparation can be done in 'Initialize'.
+// - Drawn indices are positions in [0, N). If data are accessed through an index list (e.g. 'RANSAC::FindMultiple'),
+//   the 'i'-th position is 'data[GetIndex(i)]'.
+template <class Data>
+class Sampler
+{
+public:
+    Sampler() : dataNum(0), dataIndex(NULL) { }
+
+    virtual ~Sampler() { }
+
+    virtual void Initialize(const Data& /*data*/, int N) { dataNum = N; }
+
+    // Draw 'M' distinct indices into 'samples'
+    virtual void Draw(int* samples, int M, Xoshiro256& generator) = 0;
+
+    // Set the index list of data which is used by the next 'Initialize' (NULL: all data)
+    void SetIndex(const int* index) { dataIndex = index; }
+
+protected:
+    int GetIndex(int i) const { return (dataIndex != NULL) ? dataIndex[i] : i; }
+
+    int dataNum;
+
+    const int* dataIndex;
+};
+
+// Uniform sample selection
+template <class Data>
+class UniformSampler : public Sampler<Data>
+{
+public:
+    virtual void Draw(int* samples, int M, Xoshiro256& generator) { DrawUniform(samples, M, this->dataNum, generator); }
+};
+
+} // End of 'RTL'
+
+#endif // End of '__RTL_SAMPLER__'
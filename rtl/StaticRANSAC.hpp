@@ -0,0 +1,296 @@
+#ifndef __RTL_STATIC_RANSAC__
+#define __RTL_STATIC_RANSAC__
+
+#include "Base.hpp"
+#include "Sampler.hpp"
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+#include <vector>
+
+#ifndef M_PI
+#   define M_PI                         3.14159265358979323846
+#endif
+
+namespace RTL
+{
+
+// A loss which is the sum of 'Loss::Compute' of each datum (stopped at a block whose partial loss is larger than 'bound')
+template <class Loss>
+class SumLoss
+{
+public:
+    template <class ErrorFunction>
+    double Evaluate(ErrorFunction error, int N, double threshold, double bound)
+    {
+        const int BLOCK_SIZE = 256;
+        double loss = 0;
+        for (int begin = 0; begin < N && loss <= bound; begin += BLOCK_SIZE)
+        {
+            const int end = (N - begin < BLOCK_SIZE) ? N : (begin + BLOCK_SIZE);
+            for (int i = begin; i < end; i++)
+                loss += Loss::Compute(error(i), threshold);
+        }
+        return loss;
+    }
+};
+
+// The loss of RANSAC (the number of outliers)
+class RANSACLoss : public SumLoss<RANSACLoss>
+{
+public:
+    static double Compute(double error, double threshold) { return (fabs(error) > threshold); }
+};
+
+// The loss of MSAC (the truncated quadratic loss)
+class MSACLoss : public SumLoss<MSACLoss>
+{
+public:
+    static double Compute(double error, double threshold)
+    {
+        double error2 = error * error, threshold2 = threshold * threshold;
+        return (error2 < threshold2) ? error2 : threshold2;
+    }
+};
+
+// The loss of LMedS (the median of absolute errors)
+// - A hypothesis is rejected as soon as 'N - N / 2' errors are not less than 'bound' (as 'LMedS').
+class LMedSLoss
+{
+public:
+    template <class ErrorFunction>
+    double Evaluate(ErrorFunction error, int N, double /*threshold*/, double bound)
+    {
+        const int k = N / 2, rejectNum = N - k;
+        dataErrors.resize(N);
+        int n = 0;
+        for (int i = 0; i < N; i++)
+        {
+            const double e = fabs(error(i));
+            dataErrors[n] = e;
+            n += (e < bound);
+            if (i + 1 - n >= rejectNum) return HUGE_VAL;
+        }
+        std::nth_element(dataErrors.begin(), dataErrors.begin() + k, dataErrors.begin() + n);
+        return dataErrors[k];
+    }
+
+protected:
+    std::vector<double> dataErrors;
+};
+
+// The loss of MLESAC (the negative log-likelihood of a mixture of Gaussian inliers and uniform outliers)
+// - The standard deviation of inliers is 'threshold / paramSigmaScale', and the inlier ratio is estimated by EM.
+// - Its parameters and their defaults are the same as 'MLESAC', so both give the same loss.
+class MLESACLoss
+{
+public:
+    MLESACLoss()
+    {
+        SetParamIterationEM();
+        SetParamToleranceEM();
+        SetParamSigmaScale();
+    }
+
+    template <class ErrorFunction>
+    double Evaluate(ErrorFunction error, int N, double threshold, double bound)
+    {
+        const double sigma = threshold / paramSigmaScale, sigma2 = sigma * sigma;
+
+        // Calculate Gaussian densities of errors (without the normalization)
+        dataGaussian.resize(N);
+        double minError = HUGE_VAL, maxError = -HUGE_VAL;
+        for (int i = 0; i < N; i++)
+        {
+            const double e = error(i);
+            if (e < minError) minError = e;
+            if (e > maxError) maxError = e;
+            dataGaussian[i] = exp(-0.5 * e * e / sigma2);
+        }
+        const double nu = maxError - minError;
+        const double normalizer = 1 / sqrt(2 * M_PI * sigma2);
+
+        // Estimate the inlier ratio using EM
+        double gamma = 0.5;
+        for (int iter = 0; iter < paramIterationEM; iter++)
+        {
+            const double probOutlier = (1 - gamma) / nu, probInlierCoeff = gamma * normalizer;
+            double sumPosteriorProb = 0;
+            for (int i = 0; i < N; i++)
+            {
+                const double probInlier = probInlierCoeff * dataGaussian[i];
+                sumPosteriorProb += probInlier / (probInlier + probOutlier);
+            }
+            const double gammaPrev = gamma;
+            gamma = sumPosteriorProb / N;
+            if (fabs(gamma - gammaPrev) < paramToleranceEM) break;
+        }
+
+        // Evaluate the model (stopped when even the lower bound of the total exceeds 'bound')
+        const double probOutlier = (1 - gamma) / nu, probInlierCoeff = gamma * normalizer;
+        const double lossMin = -log(probInlierCoeff + probOutlier);
+        double sumLogLikelihood = 0;
+        for (int i = 0; i < N; i++)
+        {
+            sumLogLikelihood -= log(probInlierCoeff * dataGaussian[i] + probOutlier);
+            if ((i & 255) == 255 && sumLogLikelihood + (N - i - 1) * lossMin > bound) return HUGE_VAL;
+        }
+        return sumLogLikelihood;
+    }
+
+    void SetParamIterationEM(int iteration = 5) { paramIterationEM = iteration; }
+
+    int GetParamIterationEM(void) { return paramIterationEM; }
+
+    // Set the tolerance of the inlier ratio, whose smaller change stops EM before 'paramIterationEM'
+    void SetParamToleranceEM(double tolerance = 1e-4) { paramToleranceEM = tolerance; }
+
+    double GetParamToleranceEM(void) { return paramToleranceEM; }
+
+    void SetParamSigmaScale(double scale = 1.96) { paramSigmaScale = scale; }
+
+    double GetParamSigmaScale(void) { return paramSigmaScale; }
+
+protected:
+    int paramIterationEM;
+
+    double paramToleranceEM;
+
+    double paramSigmaScale;
+
+    std::vector<double> dataGaussian;
+};
+
+// RANSAC family with static dispatch of the estimator and the loss
+// - 'Estimator' is a concrete estimator class (e.g. LineEstimator). Its 'ComputeError' is called without virtual dispatch,
+//   so it can be inlined into the evaluation loop. 'ComputeModel' is also called without virtual dispatch if the class
+//   declares the version with a sample array. Otherwise, the default implementation in 'RTL::Estimator' adapts it
+//   to 'ComputeModel(data, std::set<int>)' (with a virtual call).
+// - The sample size 'M' is given at compile time, so samples are kept in 'std::array' without any allocation.
+// - 'Loss' evaluates a hypothesis from errors of all data (RANSACLoss, MSACLoss, LMedSLoss, and MLESACLoss).
+//   It keeps its own workspace and parameters, which are accessed by 'GetLoss' (e.g. 'GetLoss().SetParamSigmaScale(2)').
+template <class Estimator, int M, class Loss = RANSACLoss>
+class StaticRANSAC
+{
+public:
+    typedef typename Estimator::ModelType Model;
+
+    typedef typename Estimator::DatumType Datum;
+
+    typedef typename Estimator::DataType Data;
+
+    StaticRANSAC(Estimator* estimator)
+    {
+        assert(estimator != NULL);
+
+        toolEstimator = estimator;
+        SetParamIteration();
+        SetParamThreshold();
+        SetParamSeed();
+        SetParamDegeneracyRedraw();
+    }
+
+    double FindBest(Model& best, const Data& data, int N)
+    {
+        assert(N >= M);
+
+        toolGenerator.Seed(paramSeed);
+        std::array<int, M> samples;
+        double bestloss = HUGE_VAL;
+        for (int iteration = 0; iteration < paramIteration; iteration++)
+        {
+            // 1. Generate hypotheses (redrawing invalid samples and models)
+            Model model;
+            for (int redraw = 0; ; redraw++)
+            {
+                DrawUniform(samples.data(), M, N, toolGenerator);
+                const bool last = (redraw >= paramDegeneracyRedraw);
+                if (!last && !toolEstimator->Estimator::IsSampleValid(data, samples.data(), M)) continue;
+                model = ComputeModel(toolEstimator, data, samples.data(), 0);
+                if (last || toolEstimator->Estimator::IsModelValid(model)) break;
+            }
+
+            // 2. Evaluate the hypotheses
+            double loss = EvaluateModel(model, data, N, bestloss);
+            if (loss < bestloss)
+            {
+                best = model;
+                bestloss = loss;
+            }
+        }
+        return bestloss;
+    }
+
+    std::vector<int> FindInliers(const Model& model, const Data& data, int N)
+    {
+        std::vector<int> inliers;
+        for (int i = 0; i < N; i++)
+        {
+            double error = toolEstimator->Estimator::ComputeError(model, data[i]);
+            if (fabs(error) < paramThreshold) inliers.push_back(i);
+        }
+        return inliers;
+    }
+
+    void SetParamIteration(int iteration = 100) { paramIteration = iteration; }
+
+    int GetParamIteration(void) { return paramIteration; }
+
+    void SetParamThreshold(double threshold = 1) { paramThreshold = threshold; }
+
+    double GetParamThreshold(void) { return paramThreshold; }
+
+    // Set the seed of the random number generator (which is restarted by every 'FindBest')
+    void SetParamSeed(unsigned int seed = 5489) { paramSeed = seed; }
+
+    unsigned int GetParamSeed(void) { return paramSeed; }
+
+    // Set the maximum number of redraws of invalid samples or models for each hypothesis
+    void SetParamDegeneracyRedraw(int count = 100) { paramDegeneracyRedraw = count; }
+
+    int GetParamDegeneracyRedraw(void) { return paramDegeneracyRedraw; }
+
+    // Get the loss (to set its parameters if it has them)
+    Loss& GetLoss(void) { return toolLoss; }
+
+protected:
+    // Calculate the loss of the given model (which can be stopped if it is larger than 'bound')
+    double EvaluateModel(const Model& model, const Data& data, int N, double bound)
+    {
+        Estimator* estimator = toolEstimator;
+        return toolLoss.Evaluate([estimator, &model, &data](int i) { return estimator->Estimator::ComputeError(model, data[i]); }, N, paramThreshold, bound);
+    }
+
+    // Compute a model without virtual dispatch if 'E' declares 'ComputeModel' with a sample array
+    template <class E>
+    static auto ComputeModel(E* estimator, const Data& data, const int* samples, int) -> decltype(estimator->E::ComputeModel(data, samples, M))
+    {
+        return estimator->E::ComputeModel(data, samples, M);
+    }
+
+    // Compute a model through 'RTL::Estimator' otherwise
+    template <class E>
+    static Model ComputeModel(E* estimator, const Data& data, const int* samples, long)
+    {
+        return static_cast<RTL::Estimator<Model, Datum, Data>*>(estimator)->ComputeModel(data, samples, M);
+    }
+
+    Xoshiro256 toolGenerator;
+
+    Estimator* toolEstimator;
+
+    Loss toolLoss;
+
+    int paramIteration;
+
+    double paramThreshold;
+
+    unsigned int paramSeed;
+
+    int paramDegeneracyRedraw;
+}; // End of 'StaticRANSAC'
+
+} // End of 'RTL'
+
+#endif // End of '__RTL_STATIC_RANSAC__'
@@ -0,0 +1,79 @@
+#ifndef __RTL_STATISTICS__
+#define __RTL_STATISTICS__
+
+#include <chrono>
+#include <vector>
+
+// Statistics of 'FindBest' are collected only if 'RTL_ENABLE_STATISTICS' is defined before including RTL
+// - Without it, 'RTL_STAT' removes all statements of collection, so there is no overhead.
+#ifdef RTL_ENABLE_STATISTICS
+#   define RTL_STAT(statement)          statement
+#else
+#   define RTL_STAT(statement)
+#endif
+
+namespace RTL
+{
+
+// Statistics of the last 'FindBest'
+// - Times of threads are summed up, so they can be larger than the wall-clock time with multiple threads.
+class Statistics
+{
+public:
+    Statistics() { Clear(); }
+
+    void Clear(void)
+    {
+        iterationNum = 0;
+        worseNum = 0;
+        degenerateNum = 0;
+        duplicateNum = 0;
+        pointNum = 0;
+        timeSample = 0;
+        timeModel = 0;
+        timeEvaluate = 0;
+        timeTotal = 0;
+        updateIterations.clear();
+    }
+
+    // Get the current time in nanoseconds (only for measuring intervals)
+    static long long GetTime(void)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // The number of generated hypotheses
+    int iterationNum;
+
+    // The number of hypotheses which are worse than the best so far (or discarded by preemption)
+    // - It includes hypotheses whose evaluation was stopped early and ones which were evaluated completely.
+    int worseNum;
+
+    // The number of samples or models which are redrawn because they are invalid (not counted in 'iterationNum')
+    int degenerateNum;
+
+    // The number of samples which are redrawn because they were already drawn (with 'SetParamDeduplication')
+    int duplicateNum;
+
+    // The number of data whose errors are calculated
+    long long pointNum;
+
+    // The time of sampling [sec]
+    double timeSample;
+
+    // The time of 'ComputeModel' [sec]
+    double timeModel;
+
+    // The time of 'EvaluateModel' [sec]
+    double timeEvaluate;
+
+    // The wall-clock time of 'FindBest' [sec]
+    double timeTotal;
+
+    // The iteration where the best model is updated (its size is the number of updates)
+    std::vector<int> updateIterations;
+}; // End of 'Statistics'
+
+} // End of 'RTL'
+
+#endif // End of '__RTL_STATISTICS__'
@@ -0,0 +1,271 @@
+#ifndef __RTL_STREAM_RANSAC__
+#define __RTL_STREAM_RANSAC__
+
+#include "Base.hpp"
+#include "Sampler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+
+namespace RTL
+{
+
+// RANSAC on a sliding window of continuously arriving data
+// - Data are kept in a ring buffer. 'Push' and 'Evict' only update the support (the number of inliers) of the kept
+//   hypotheses with the added or evicted datum, so each update takes O(K) with K hypotheses.
+// - New hypotheses are drawn from the window only when the support ratio of the best hypothesis falls below
+//   'paramRedrawRatio' times its ratio when it became the best.
+// - If the estimator provides an 'Accumulator', the best model is refitted to its inliers incrementally.
+// - 'Data' is the ring buffer, so it should be resizable and writable with 'operator[]' (e.g. 'std::vector<Datum>').
+template <class Model, class Datum, class Data>
+class StreamRANSAC
+{
+public:
+    StreamRANSAC(Estimator<Model, Datum, Data>* estimator, int capacity, int M)
+    {
+        assert(estimator != NULL && capacity >= M && M > 0);
+
+        toolEstimator = estimator;
+        toolAccumulator = estimator->CreateAccumulator();
+        paramCapacity = capacity;
+        paramSampleSize = M;
+        SetParamThreshold();
+        SetParamHypothesisNum();
+        SetParamIteration();
+        SetParamRedrawRatio();
+        SetParamDegeneracyRedraw();
+        SetParamSeed();
+        Clear();
+    }
+
+    virtual ~StreamRANSAC() { delete toolAccumulator; }
+
+    // Add a datum to the window (evicting the oldest one if the window is full)
+    void Push(const Datum& datum)
+    {
+        if (dataSize == paramCapacity) RemoveOldest();
+        const int slot = (dataHead + dataSize) % paramCapacity;
+        dataBuffer[slot] = datum;
+        dataSize++;
+        for (size_t h = 0; h < dataHypotheses.size(); h++)
+            dataHypotheses[h].support += IsInlier(dataHypotheses[h].model, datum);
+        if (IsAccumulated() && IsInlier(dataHypotheses[0].model, datum)) toolAccumulator->Add(datum);
+        Update();
+    }
+
+    // Remove the oldest datum from the window
+    void Evict(void)
+    {
+        if (dataSize <= 0) return;
+        RemoveOldest();
+        Update();
+    }
+
+    // Remove all data and hypotheses
+    void Clear(void)
+    {
+        dataBuffer.resize(paramCapacity);
+        dataHead = 0;
+        dataSize = 0;
+        dataHypotheses.clear();
+        dataBestRatio = 0;
+        dataRedrawCount = 0;
+        dataAccumulated = false;
+        toolGenerator.Seed(paramSeed);
+    }
+
+    // Get the best model (refitted to its inliers if possible)
+    // - The inliers are accumulated again only when the best hypothesis has been changed.
+    bool GetBest(Model& model)
+    {
+        if (dataHypotheses.empty()) return false;
+        if (toolAccumulator != NULL && !dataAccumulated)
+        {
+            toolAccumulator->Clear();
+            for (int j = 0; j < dataSize; j++)
+            {
+                const Datum& datum = dataBuffer[(dataHead + j) % paramCapacity];
+                if (IsInlier(dataHypotheses[0].model, datum)) toolAccumulator->Add(datum);
+            }
+            dataAccumulated = true;
+        }
+        if (toolAccumulator != NULL && toolAccumulator->GetCount() > paramSampleSize) model = toolAccumulator->ComputeModel();
+        else model = dataHypotheses[0].model;
+        return true;
+    }
+
+    // Get the number of inliers of the best model in the window
+    int GetSupport(void) { return dataHypotheses.empty() ? 0 : dataHypotheses[0].support; }
+
+    // Get the number of data in the window
+    int GetSize(void) { return dataSize; }
+
+    // Get the number of times new hypotheses are drawn
+    int GetRedrawCount(void) { return dataRedrawCount; }
+
+    void SetParamThreshold(double threshold = 1) { paramThreshold = threshold; }
+
+    double GetParamThreshold(void) { return paramThreshold; }
+
+    // Set the number of hypotheses which are kept and updated with each datum
+    void SetParamHypothesisNum(int number = 8) { paramHypothesisNum = number; }
+
+    int GetParamHypothesisNum(void) { return paramHypothesisNum; }
+
+    // Set the number of hypotheses which are drawn when the best one degrades
+    void SetParamIteration(int iteration = 100) { paramIteration = iteration; }
+
+    int GetParamIteration(void) { return paramIteration; }
+
+    // Set the ratio of the support ratio (to its ratio when it became the best) under which new hypotheses are drawn
+    void SetParamRedrawRatio(double ratio = 0.8) { paramRedrawRatio = ratio; }
+
+    double GetParamRedrawRatio(void) { return paramRedrawRatio; }
+
+    // Set the maximum number of redraws of invalid samples or models for each hypothesis
+    // - Validity is checked by 'Estimator::IsSampleValid' and 'Estimator::IsModelValid' as 'RANSAC' does.
+    void SetParamDegeneracyRedraw(int count = 100) { paramDegeneracyRedraw = count; }
+
+    int GetParamDegeneracyRedraw(void) { return paramDegeneracyRedraw; }
+
+    // Set the seed of the random number generator (which is applied by 'Clear')
+    void SetParamSeed(unsigned int seed = 5489) { paramSeed = seed; }
+
+    unsigned int GetParamSeed(void) { return paramSeed; }
+
+protected:
+    class Hypothesis
+    {
+    public:
+        Model model;
+
+        int support;
+
+        bool operator<(const Hypothesis& rhs) const { return support > rhs.support; }
+    };
+
+    bool IsInlier(const Model& model, const Datum& datum) { return fabs(toolEstimator->ComputeError(model, datum)) < paramThreshold; }
+
+    // Check whether the accumulator keeps inliers of the best hypothesis
+    bool IsAccumulated(void) { return toolAccumulator != NULL && dataAccumulated; }
+
+    void RemoveOldest(void)
+    {
+        const Datum& datum = dataBuffer[dataHead];
+        for (size_t h = 0; h < dataHypotheses.size(); h++)
+            dataHypotheses[h].support -= IsInlier(dataHypotheses[h].model, datum);
+        if (IsAccumulated() && IsInlier(dataHypotheses[0].model, datum)) toolAccumulator->Remove(datum);
+        dataHead = (dataHead + 1) % paramCapacity;
+        dataSize--;
+    }
+
+    // Keep the best hypothesis at the front, and draw new hypotheses if it degrades
+    void Update(void)
+    {
+        if (dataSize < paramSampleSize) return;
+        int best = 0;
+        for (size_t h = 1; h < dataHypotheses.size(); h++)
+            if (dataHypotheses[h].support > dataHypotheses[best].support) best = static_cast<int>(h);
+        if (best != 0)
+        {
+            std::swap(dataHypotheses[0], dataHypotheses[best]);
+            SetBest();
+        }
+
+        const double ratio = dataHypotheses.empty() ? 0 : static_cast<double>(dataHypotheses[0].support) / dataSize;
+        if (dataHypotheses.empty() || ratio < paramRedrawRatio * dataBestRatio)
+        {
+            Redraw();
+            SetBest();
+        }
+    }
+
+    // Draw new hypotheses from the window and keep the best ones with the existing hypotheses
+    void Redraw(void)
+    {
+        const int M = paramSampleSize;
+        std::vector<int> samples(M);
+        for (int i = 0; i < paramIteration; i++)
+        {
+            Hypothesis hypothesis;
+            hypothesis.model = GenerateValidModel(&samples[0], M);
+            hypothesis.support = 0;
+            for (int j = 0; j < dataSize; j++)
+                hypothesis.support += IsInlier(hypothesis.model, dataBuffer[(dataHead + j) % paramCapacity]);
+            dataHypotheses.push_back(hypothesis);
+        }
+        std::stable_sort(dataHypotheses.begin(), dataHypotheses.end());
+        if (static_cast<int>(dataHypotheses.size()) > paramHypothesisNum) dataHypotheses.resize(paramHypothesisNum);
+        dataRedrawCount++;
+    }
+
+    // Draw samples from the window and compute a model until both are valid (at most 'paramDegeneracyRedraw' redraws)
+    // - Samples are mapped to slots of the ring buffer, so the estimator sees indices in 'dataBuffer'.
+    Model GenerateValidModel(int* samples, int M)
+    {
+        Model model;
+        for (int redraw = 0; ; redraw++)
+        {
+            DrawUniform(samples, M, dataSize, toolGenerator);
+            for (int m = 0; m < M; m++) samples[m] = (dataHead + samples[m]) % paramCapacity;
+            const bool last = (redraw >= paramDegeneracyRedraw);
+            if (!last && !toolEstimator->IsSampleValid(dataBuffer, samples, M)) continue;
+            model = toolEstimator->ComputeModel(dataBuffer, samples, M);
+            if (last || toolEstimator->IsModelValid(model)) break;
+        }
+        return model;
+    }
+
+    // Reset the reference ratio of the new best hypothesis (and its inliers are accumulated later)
+    void SetBest(void)
+    {
+        if (dataHypotheses.empty()) return;
+        dataBestRatio = static_cast<double>(dataHypotheses[0].support) / dataSize;
+        dataAccumulated = false;
+    }
+
+    Estimator<Model, Datum, Data>* toolEstimator;
+
+    Accumulator<Model, Datum>* toolAccumulator;
+
+    Xoshiro256 toolGenerator;
+
+    int paramCapacity;
+
+    int paramSampleSize;
+
+    double paramThreshold;
+
+    int paramHypothesisNum;
+
+    int paramIteration;
+
+    double paramRedrawRatio;
+
+    int paramDegeneracyRedraw;
+
+    unsigned int paramSeed;
+
+    Data dataBuffer;
+
+    int dataHead;
+
+    int dataSize;
+
+    std::vector<Hypothesis> dataHypotheses;
+
+    double dataBestRatio;
+
+    int dataRedrawCount;
+
+    bool dataAccumulated;
+
+private:
+    StreamRANSAC(const StreamRANSAC&);
+
+    StreamRANSAC& operator=(const StreamRANSAC&);
+}; // End of 'StreamRANSAC'
+
+} // End of 'RTL'
+
+#endif // End of '__RTL_STREAM_RANSAC__'
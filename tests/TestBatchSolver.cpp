@@ -0,0 +1,59 @@
+#include "RTL.hpp"
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+typedef vector<Point> Data;
+
+// Check that 'BatchSolver' on multiple threads gives the same results as sequential 'FindBest' with the same seed
+// - Each thread reuses its algorithm for many problems, so the algorithm should not keep any state of the previous problem.
+int main(void)
+{
+    const int PROBLEM_NUM = 64;
+    LineObserver observer;
+    vector<Data> problems(PROBLEM_NUM);
+    for (int p = 0; p < PROBLEM_NUM; p++)
+    {
+        vector<int> inliers;
+        observer.SetSeed(p);
+        problems[p] = observer.GenerateData(Line(0.6, 0.8, -300 - p), 50 + 10 * p, inliers, 1, 0.3 + 0.01 * p);
+    }
+    LineEstimator estimator;
+    bool success = true;
+
+    RTL::BatchSolver<Line, Point, Data> batch([&]() { return new RTL::MSAC<Line, Point, Data>(&estimator); });
+    batch.SetParamThreadNum(4);
+    batch.SetParamChunkSize(1);
+    batch.SetParamSeed(7);
+    for (int p = 0; p < PROBLEM_NUM; p++) batch.Add(problems[p], problems[p].size(), 2);
+    vector<Line> models;
+    vector<double> losses;
+    vector<char> masks;
+    int found = batch.Solve(models, losses, masks);
+    if (found != PROBLEM_NUM)
+    {
+        cout << "BatchSolver: " << found << " / " << PROBLEM_NUM << " problems" << endl;
+        success = false;
+    }
+
+    RTL::MSAC<Line, Point, Data> msac(&estimator);
+    msac.SetParamThreadNum(1);
+    msac.SetParamSeed(7);
+    for (int p = 0; p < PROBLEM_NUM; p++)
+    {
+        Line model;
+        double loss = msac.FindBest(model, problems[p], problems[p].size(), 2);
+        vector<int> inliers = msac.FindInliers(model, problems[p], problems[p].size());
+        vector<char> mask(problems[p].size(), 0);
+        for (size_t i = 0; i < inliers.size(); i++) mask[inliers[i]] = 1;
+        const int offset = batch.GetMaskOffset(p);
+        if (loss != losses[p] || model.a != models[p].a || model.b != models[p].b || model.c != models[p].c
+            || !equal(mask.begin(), mask.end(), masks.begin() + offset))
+        {
+            cout << "Problem " << p << ": " << models[p] << " (Loss: " << losses[p] << ") != " << model << " (Loss: " << loss << ")" << endl;
+            success = false;
+        }
+    }
+    return success ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+#include "RTL.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <set>
+
+using namespace std;
+
+typedef vector<Point> Data;
+
+// A line estimator which records samples whose models are computed
+class LineRecorder : public LineEstimator
+{
+public:
+    virtual Line ComputeModel(const Data& data, const int* samples, int M)
+    {
+        vector<int> sample(samples, samples + M);
+        sort(sample.begin(), sample.end());
+        drawn.push_back(sample);
+        return LineEstimator::ComputeModel(data, samples, M);
+    }
+
+    vector<vector<int> > drawn;
+};
+
+// Get the MSAC loss of the given model
+double GetLoss(LineEstimator& estimator, const Line& model, const Data& data, double threshold)
+{
+    double loss = 0;
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        double error = estimator.ComputeError(model, data[i]);
+        loss += min(error * error, threshold * threshold);
+    }
+    return loss;
+}
+
+// Check that deduplication does not compute a model of the same sample twice
+// - If all samples are not more than the iterations, they are enumerated once, so the best model is the brute-force optimum.
+int main(void)
+{
+    vector<int> inliers;
+    LineObserver observer;
+    Data data = observer.GenerateData(Line(0.6, 0.8, -300), 30, inliers, 1, 0.5);
+    bool success = true;
+
+    // Deduplication of random samples (200 samples among C(30, 2) = 435 ones)
+    LineRecorder recorder;
+    RTL::MSAC<Line, Point, Data> msac(&recorder);
+    msac.SetParamThreshold(3);
+    msac.SetParamIteration(200);
+    msac.SetParamDeduplication(true);
+    Line model;
+    msac.FindBest(model, data, data.size(), 2);
+    set<vector<int> > unique(recorder.drawn.begin(), recorder.drawn.end());
+    if (recorder.drawn.size() != 200 || unique.size() != recorder.drawn.size())
+    {
+        cout << "Deduplication: " << unique.size() << " unique samples among " << recorder.drawn.size() << endl;
+        success = false;
+    }
+
+    // Exhaustive enumeration (C(12, 2) = 66 samples)
+    const int N = 12;
+    recorder.drawn.clear();
+    double loss = msac.FindBest(model, data, N, 2);
+    unique = set<vector<int> >(recorder.drawn.begin(), recorder.drawn.end());
+    double bestLoss = HUGE_VAL;
+    Line best;
+    for (int i = 0; i < N; i++)
+    {
+        for (int j = i + 1; j < N; j++)
+        {
+            const int samples[] = { i, j };
+            Line candidate = recorder.LineEstimator::ComputeModel(data, samples, 2);
+            double candidateLoss = GetLoss(recorder, candidate, Data(data.begin(), data.begin() + N), 3);
+            if (candidateLoss < bestLoss)
+            {
+                bestLoss = candidateLoss;
+                best = candidate;
+            }
+        }
+    }
+    if (msac.GetIterationCount() != 66 || recorder.drawn.size() != 66 || unique.size() != 66 || fabs(loss - bestLoss) > 1e-9 * bestLoss)
+    {
+        cout << "Exhaustive enumeration (Iterations: " << msac.GetIterationCount() << ", Unique samples: " << unique.size() << "): "
+             << model << " (Loss: " << loss << ") != " << best << " (Loss: " << bestLoss << ")" << endl;
+        success = false;
+    }
+    return success ? 0 : 1;
+}
@@ -0,0 +1,49 @@
+#include "RTL.hpp"
+#include <iostream>
+
+using namespace std;
+
+// Check that 'FindBest' returns the same model for the same seed and thread number
+// - It is called twice on the same object, and once more on a new object.
+// - Few iterations on data with many outliers make models from different samples differ.
+template <class Algorithm>
+bool CheckDeterminism(const char* name, int threadNum, LineEstimator& estimator, const vector<Point>& data)
+{
+    Algorithm first(&estimator), second(&estimator);
+    first.SetParamIteration(20);
+    first.SetParamThreadNum(threadNum);
+    second.SetParamIteration(20);
+    second.SetParamThreadNum(threadNum);
+
+    Line model[3];
+    double loss[3];
+    loss[0] = first.FindBest(model[0], data, data.size(), 2);
+    loss[1] = first.FindBest(model[1], data, data.size(), 2);
+    loss[2] = second.FindBest(model[2], data, data.size(), 2);
+    for (int i = 1; i < 3; i++)
+    {
+        if (loss[i] != loss[0] || model[i].a != model[0].a || model[i].b != model[0].b || model[i].c != model[0].c)
+        {
+            cout << name << " (threads: " << threadNum << "): " << model[i] << " (Loss: " << loss[i] << ") != " << model[0] << " (Loss: " << loss[0] << ")" << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(void)
+{
+    vector<int> inliers;
+    LineObserver observer;
+    vector<Point> data = observer.GenerateData(Line(0.6, 0.8, -300), 1000, inliers, 1, 0.3);
+    LineEstimator estimator;
+
+    bool success = true;
+    const int THREAD_NUM[] = { 1, 4 };
+    for (int t = 0; t < 2; t++)
+    {
+        success &= CheckDeterminism<RTL::RANSAC<Line, Point, vector<Point> > >("RANSAC", THREAD_NUM[t], estimator, data);
+        success &= CheckDeterminism<RTL::MSAC<Line, Point, vector<Point> > >("MSAC", THREAD_NUM[t], estimator, data);
+    }
+    return success ? 0 : 1;
+}
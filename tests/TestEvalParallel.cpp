@@ -0,0 +1,49 @@
+#include "RTL.hpp"
+#include <cmath>
+#include <iostream>
+
+using namespace std;
+
+typedef vector<Point> Data;
+
+// Check that data-parallel evaluation gives the same model, loss, and inliers as serial evaluation
+// - Partial sums are added in a different order, so losses are compared with a relative tolerance.
+template <class Algorithm>
+bool CheckEvalParallel(const char* name, LineEstimator& estimator, const Data& data)
+{
+    Algorithm serial(&estimator), parallel(&estimator);
+    serial.SetParamThreshold(3);
+    parallel.SetParamThreshold(3);
+    parallel.SetParamEvalThreadNum(4);
+    parallel.SetParamEvalBlockSize(1000);
+
+    Line model[2];
+    double loss[2];
+    loss[0] = serial.FindBest(model[0], data, data.size(), 2);
+    loss[1] = parallel.FindBest(model[1], data, data.size(), 2);
+    vector<int> inliers[2];
+    inliers[0] = serial.FindInliers(model[0], data, data.size());
+    inliers[1] = parallel.FindInliers(model[1], data, data.size());
+    if (fabs(loss[1] - loss[0]) > 1e-9 * fabs(loss[0]) || model[1].a != model[0].a || model[1].b != model[0].b || model[1].c != model[0].c || inliers[1] != inliers[0])
+    {
+        cout << name << ": " << model[1] << " (Loss: " << loss[1] << ", Inliers: " << inliers[1].size() << ") != "
+             << model[0] << " (Loss: " << loss[0] << ", Inliers: " << inliers[0].size() << ")" << endl;
+        return false;
+    }
+    return true;
+}
+
+int main(void)
+{
+    vector<int> inliers;
+    LineObserver observer;
+    Data data = observer.GenerateData(Line(0.6, 0.8, -300), 20000, inliers, 1, 0.5);
+    LineEstimator estimator;
+
+    bool success = true;
+    success &= CheckEvalParallel<RTL::RANSAC<Line, Point, Data> >("RANSAC", estimator, data);
+    success &= CheckEvalParallel<RTL::MSAC<Line, Point, Data> >("MSAC", estimator, data);
+    success &= CheckEvalParallel<RTL::LMedS<Line, Point, Data> >("LMedS", estimator, data);
+    success &= CheckEvalParallel<RTL::MLESAC<Line, Point, Data> >("MLESAC", estimator, data);
+    return success ? 0 : 1;
+}
@@ -0,0 +1,60 @@
+#include "RTL.hpp"
+#include <cmath>
+#include <iostream>
+
+using namespace std;
+
+typedef vector<Point> Data;
+
+// Check that 'FindMultiple' finds two lines one by one with disjoint inliers
+// - The inliers of each model are same with its inliers among data which are not inliers of the previous models.
+// - It stops at the remaining outliers, which do not have enough inliers.
+int main(void)
+{
+    const Line truth[] = { Line(0.6, 0.8, -300), Line(0.8, -0.6, -100) };
+    const int TRUTH_NUM[] = { 300, 200 };
+    vector<int> trueInliers;
+    LineObserver observer;
+    Data data = observer.GenerateData(truth[0], TRUTH_NUM[0], trueInliers, 1, 1);
+    Data second = observer.GenerateData(truth[1], TRUTH_NUM[1], trueInliers, 1, 1);
+    Data outliers = observer.GenerateData(truth[0], 200, trueInliers, 1, 0);
+    data.insert(data.end(), second.begin(), second.end());
+    data.insert(data.end(), outliers.begin(), outliers.end());
+    LineEstimator estimator;
+    bool success = true;
+
+    RTL::MSAC<Line, Point, Data> msac(&estimator);
+    msac.SetParamThreshold(3);
+    vector<Line> models;
+    vector<vector<int> > inliers;
+    int found = msac.FindMultiple(models, inliers, data, data.size(), 2, 0, 50);
+    if (found != 2)
+    {
+        cout << "FindMultiple: " << found << " models" << endl;
+        return 1;
+    }
+
+    vector<bool> removed(data.size(), false);
+    for (int k = 0, begin = 0; k < found; begin += TRUTH_NUM[k], k++)
+    {
+        // The inliers among the remaining data
+        vector<int> reference;
+        int inlierNum = 0;
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            if (removed[i] || fabs(estimator.ComputeError(models[k], data[i])) >= 3) continue;
+            reference.push_back(static_cast<int>(i));
+            inlierNum += (static_cast<int>(i) >= begin && static_cast<int>(i) < begin + TRUTH_NUM[k]);
+        }
+        for (size_t j = 0; j < reference.size(); j++) removed[reference[j]] = true;
+
+        const double dot = models[k].a * truth[k].a + models[k].b * truth[k].b;
+        if (inliers[k] != reference || inlierNum < 0.95 * TRUTH_NUM[k] || fabs(dot) < 0.99)
+        {
+            cout << "Model " << k << ": " << models[k] << " (Inliers: " << inliers[k].size() << ", Reference: " << reference.size()
+                 << ", True inliers: " << inlierNum << " / " << TRUTH_NUM[k] << ")" << endl;
+            success = false;
+        }
+    }
+    return success ? 0 : 1;
+}
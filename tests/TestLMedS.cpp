@@ -0,0 +1,61 @@
+#include "RTL.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+using namespace std;
+
+typedef vector<Point> Data;
+
+// LMedS which evaluates the median of all errors without early rejection
+class LMedSReference : public RTL::LMedS<Line, Point, Data>
+{
+public:
+    LMedSReference(RTL::Estimator<Line, Point, Data>* estimator) : RTL::RANSAC<Line, Point, Data>(estimator), RTL::LMedS<Line, Point, Data>(estimator) { }
+
+protected:
+    virtual double EvaluateModel(const Line& model, const Data& data, int N)
+    {
+        vector<double> errors(N);
+        for (int i = 0; i < N; i++) errors[i] = fabs(toolEstimator->ComputeError(model, data[i]));
+        nth_element(errors.begin(), errors.begin() + N / 2, errors.end());
+        return errors[N / 2];
+    }
+};
+
+// Check that LMedS with early rejection finds the same model and median as the reference
+// - Small and large data select the median in different ways, and so does data-parallel evaluation.
+bool CheckLMedS(int N, int evalThreadNum)
+{
+    vector<int> inliers;
+    LineObserver observer;
+    Data data = observer.GenerateData(Line(0.6, 0.8, -300), N, inliers, 1, 0.6);
+    LineEstimator estimator;
+
+    RTL::LMedS<Line, Point, Data> lmeds(&estimator);
+    LMedSReference reference(&estimator);
+    lmeds.SetParamIteration(200);
+    lmeds.SetParamEvalThreadNum(evalThreadNum);
+    reference.SetParamIteration(200);
+
+    Line model[2];
+    double loss[2];
+    loss[0] = reference.FindBest(model[0], data, N, 2);
+    loss[1] = lmeds.FindBest(model[1], data, N, 2);
+    if (loss[1] != loss[0] || model[1].a != model[0].a || model[1].b != model[0].b || model[1].c != model[0].c)
+    {
+        cout << "LMedS (N: " << N << ", threads: " << evalThreadNum << "): " << model[1] << " (Loss: " << loss[1] << ") != "
+             << model[0] << " (Loss: " << loss[0] << ")" << endl;
+        return false;
+    }
+    return true;
+}
+
+int main(void)
+{
+    bool success = true;
+    success &= CheckLMedS(1000, 1);
+    success &= CheckLMedS(20000, 1);
+    success &= CheckLMedS(20000, 4);
+    return success ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+#include "RTL.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+using namespace std;
+
+typedef vector<double> Data;
+
+// A 1-D location estimator of scalars
+class LocationEstimator : public RTL::Estimator<double, double, Data>
+{
+public:
+    virtual double ComputeModel(const Data& data, const set<int>& samples) { return data[*samples.begin()]; }
+
+    virtual double ComputeError(const double& model, const double& datum) { return datum - model; }
+
+    virtual bool GetLocation(const double& datum, double& location)
+    {
+        location = datum;
+        return true;
+    }
+
+    virtual double GetLocationModel(double location) { return location; }
+};
+
+// Get the RANSAC loss (the number of outliers) or MSAC loss of the given location
+double GetLoss(double location, const Data& data, double threshold, bool msac)
+{
+    double loss = 0;
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        const double error = data[i] - location;
+        if (msac) loss += min(error * error, threshold * threshold);
+        else loss += (fabs(error) > threshold);
+    }
+    return loss;
+}
+
+// Get the best loss by brute force
+// - RANSAC: Windows which begin at each datum cover all sets of inliers.
+// - MSAC: The minimizer is the mean of its inliers, which are contiguous in the sorted order.
+double FindBestLoss(Data data, double threshold, bool msac)
+{
+    sort(data.begin(), data.end());
+    double best = HUGE_VAL;
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        if (!msac) best = min(best, GetLoss(data[i] + threshold, data, threshold, msac));
+        else
+        {
+            double sum = 0;
+            for (size_t j = i; j < data.size(); j++)
+            {
+                sum += data[j];
+                best = min(best, GetLoss(sum / (j - i + 1), data, threshold, msac));
+            }
+        }
+    }
+    return best;
+}
+
+// Check that 'LocationSolver' and 'RANSAC' and 'MSAC' with 'SetParamExactLocation' find the brute-force optimum
+template <class Algorithm>
+bool CheckLocation(const char* name, bool msac, LocationEstimator& estimator, const Data& data, double threshold)
+{
+    RTL::LocationSolver<double, double, Data> solver(&estimator);
+    solver.SetParamThreshold(threshold);
+    solver.SetParamMSAC(msac);
+    Algorithm algorithm(&estimator);
+    algorithm.SetParamThreshold(threshold);
+
+    double model[2];
+    double loss[2];
+    loss[0] = solver.FindBest(model[0], data, data.size());
+    loss[1] = algorithm.FindBest(model[1], data, data.size(), 1);
+    const double reference = FindBestLoss(data, threshold, msac);
+    const double tolerance = 1e-9 * (reference + 1);
+    bool success = true;
+    for (int k = 0; k < 2; k++)
+    {
+        if (fabs(loss[k] - reference) > tolerance || fabs(GetLoss(model[k], data, threshold, msac) - reference) > tolerance)
+        {
+            cout << name << (k ? "" : " (LocationSolver)") << ": " << model[k] << " (Loss: " << loss[k] << ") != " << reference << endl;
+            success = false;
+        }
+    }
+    if (algorithm.GetIterationCount() != 0)
+    {
+        cout << name << ": " << algorithm.GetIterationCount() << " iterations" << endl;
+        success = false;
+    }
+    return success;
+}
+
+int main(void)
+{
+    // Inliers around 10 with outliers from 0 to 100
+    mt19937 generator(3);
+    normal_distribution<double> normal(10, 1);
+    uniform_real_distribution<double> uniform(0, 100);
+    Data data;
+    for (int i = 0; i < 120; i++) data.push_back(normal(generator));
+    for (int i = 0; i < 80; i++) data.push_back(uniform(generator));
+    LocationEstimator estimator;
+
+    bool success = true;
+    success &= CheckLocation<RTL::RANSAC<double, double, Data> >("RANSAC", false, estimator, data, 2);
+    success &= CheckLocation<RTL::MSAC<double, double, Data> >("MSAC", true, estimator, data, 2);
+    return success ? 0 : 1;
+}
@@ -0,0 +1,103 @@
+#include "RTL.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+
+using namespace std;
+
+typedef vector<Point> Data;
+
+typedef RTL::MappedArray<Point> MappedData;
+
+// Read a file of inlier indices or a bitmask of 'N' data as inlier indices
+vector<int> ReadInliers(const char* path, bool bitmask, int N)
+{
+    vector<int> inliers;
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) return inliers;
+    if (bitmask)
+    {
+        vector<unsigned char> bits((N + 7) / 8, 0);
+        if (fread(&bits[0], 1, bits.size(), file) == bits.size())
+            for (int i = 0; i < N; i++)
+                if (bits[i / 8] & (1 << (i % 8))) inliers.push_back(i);
+    }
+    else
+    {
+        int64_t index;
+        while (fread(&index, sizeof(index), 1, file) == 1) inliers.push_back(static_cast<int>(index));
+    }
+    fclose(file);
+    return inliers;
+}
+
+// Check that 'MappedArray' of a binary file gives the same results as 'std::vector' of the same data
+// - Inliers are written by 'RANSAC::WriteInliers' on the whole file, and by 'WriteMappedInliers' window by window.
+int main(void)
+{
+    const char* input = "TestMappedArray.bin";
+    const char* output = "TestMappedArray.inliers";
+    vector<int> trueInliers;
+    LineObserver observer;
+    Data data = observer.GenerateData(Line(0.6, 0.8, -300), 5000, trueInliers, 1, 0.5);
+    const int N = static_cast<int>(data.size());
+    FILE* file = fopen(input, "wb");
+    if (file == NULL) return 1;
+    fwrite(&data[0], sizeof(Point), data.size(), file);
+    fclose(file);
+    bool success = true;
+
+    // The round trip
+    MappedData mapped(input);
+    if (!mapped.IsOpen() || mapped.GetRecordNum() != data.size() || mapped.size() != data.size() || mapped[N - 1].x != data[N - 1].x || mapped[N - 1].y != data[N - 1].y)
+    {
+        cout << "MappedArray: " << mapped.size() << " records" << endl;
+        remove(input);
+        return 1;
+    }
+    mapped.SetWindow(1000, 2000);
+    if (mapped.size() != 2000 || mapped[0].x != data[1000].x || mapped[0].y != data[1000].y)
+    {
+        cout << "MappedArray with a window: " << mapped.size() << " records from " << mapped.GetWindowBegin() << endl;
+        success = false;
+    }
+    mapped.ResetWindow();
+
+    // 'FindBest' and 'FindInliers'
+    LineEstimator estimator;
+    LineEstimatorT<MappedData> mappedEstimator;
+    RTL::MSAC<Line, Point, Data> msac(&estimator);
+    RTL::MSAC<Line, Point, MappedData> mappedMSAC(&mappedEstimator);
+    msac.SetParamThreshold(3);
+    mappedMSAC.SetParamThreshold(3);
+    Line model, mappedModel;
+    double loss = msac.FindBest(model, data, N, 2);
+    double mappedLoss = mappedMSAC.FindBest(mappedModel, mapped, N, 2);
+    vector<int> inliers = msac.FindInliers(model, data, N);
+    if (mappedLoss != loss || mappedModel.a != model.a || mappedModel.b != model.b || mappedModel.c != model.c || mappedMSAC.FindInliers(mappedModel, mapped, N) != inliers)
+    {
+        cout << "MSAC on MappedArray: " << mappedModel << " (Loss: " << mappedLoss << ") != " << model << " (Loss: " << loss << ")" << endl;
+        success = false;
+    }
+
+    // 'WriteInliers' and 'WriteMappedInliers' (with windows which do not divide the data)
+    for (int bitmask = 0; bitmask < 2; bitmask++)
+    {
+        long long count = mappedMSAC.WriteInliers(mappedModel, mapped, N, output, bitmask != 0);
+        if (count != static_cast<long long>(inliers.size()) || ReadInliers(output, bitmask != 0, N) != inliers)
+        {
+            cout << "WriteInliers (bitmask: " << bitmask << "): " << count << " inliers" << endl;
+            success = false;
+        }
+        count = RTL::WriteMappedInliers(mappedMSAC, mappedModel, mapped, output, bitmask != 0, 1024);
+        if (count != static_cast<long long>(inliers.size()) || ReadInliers(output, bitmask != 0, N) != inliers || mapped.size() != data.size())
+        {
+            cout << "WriteMappedInliers (bitmask: " << bitmask << "): " << count << " inliers" << endl;
+            success = false;
+        }
+    }
+    mapped.Close();
+    remove(input);
+    remove(output);
+    return success ? 0 : 1;
+}
@@ -0,0 +1,64 @@
+#include "RTL.hpp"
+#include <cmath>
+#include <iostream>
+
+using namespace std;
+
+typedef vector<Point> Data;
+
+// Check that 'PROSAC' draws samples in the given quality order
+// - The first hypothesis is the model of the best 'M' data.
+// - With inliers ranked first, it finds the true line after a few iterations.
+// - An order without all data fails with 'HUGE_VAL'.
+int main(void)
+{
+    vector<int> trueInliers;
+    LineObserver observer;
+    Data data = observer.GenerateData(Line(0.6, 0.8, -300), 1000, trueInliers, 1, 0.2);
+    LineEstimator estimator;
+    bool success = true;
+
+    vector<double> quality(data.size(), 0);
+    for (size_t i = 0; i < trueInliers.size(); i++) quality[trueInliers[i]] = 1;
+    RTL::PROSAC<Line, Point, Data> prosac(&estimator);
+    prosac.SetParamThreshold(3);
+    prosac.SetQuality(quality);
+
+    // The first hypothesis
+    Line model;
+    prosac.SetParamIteration(1);
+    prosac.FindBest(model, data, data.size(), 2);
+    const int samples[] = { trueInliers[0], trueInliers[1] };
+    Line reference = estimator.ComputeModel(data, samples, 2);
+    if (fabs(model.a - reference.a) > 1e-9 || fabs(model.b - reference.b) > 1e-9 || fabs(model.c - reference.c) > 1e-6)
+    {
+        cout << "The first hypothesis: " << model << " != " << reference << endl;
+        success = false;
+    }
+
+    // The true line
+    prosac.SetParamIteration(1000);
+    double loss = prosac.FindBest(model, data, data.size(), 2);
+    vector<int> inliers = prosac.FindInliers(model, data, data.size());
+    int found = 0;
+    for (size_t i = 0, j = 0; i < inliers.size(); i++)
+    {
+        while (j < trueInliers.size() && trueInliers[j] < inliers[i]) j++;
+        found += (j < trueInliers.size() && trueInliers[j] == inliers[i]);
+    }
+    if (loss >= HUGE_VAL || prosac.GetIterationCount() > 20 || found < 0.95 * trueInliers.size())
+    {
+        cout << "PROSAC (Iterations: " << prosac.GetIterationCount() << "): " << model << " (Inliers: " << found << " / " << trueInliers.size() << ")" << endl;
+        success = false;
+    }
+
+    // The wrong order
+    prosac.SetOrder(vector<int>(trueInliers.begin(), trueInliers.end()));
+    loss = prosac.FindBest(model, data, data.size(), 2);
+    if (loss < HUGE_VAL)
+    {
+        cout << "PROSAC with " << trueInliers.size() << " / " << data.size() << " ranked data: " << loss << endl;
+        success = false;
+    }
+    return success ? 0 : 1;
+}
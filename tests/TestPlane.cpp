@@ -0,0 +1,98 @@
+#include "RTL.hpp"
+#include <cmath>
+#include <iostream>
+
+using namespace std;
+
+typedef vector<Point3> Data;
+
+// Check that the given plane is same with the true plane (whose sign can be flipped)
+bool IsSame(const Plane& plane, const Plane& truth, double tolerance)
+{
+    const double sign = (plane.a * truth.a + plane.b * truth.b + plane.c * truth.c < 0) ? -1 : 1;
+    return fabs(sign * plane.a - truth.a) < tolerance && fabs(sign * plane.b - truth.b) < tolerance
+        && fabs(sign * plane.c - truth.c) < tolerance && fabs(sign * plane.d - truth.d) < 100 * tolerance;
+}
+
+// Check that planes fitted to noiseless points are the true plane
+// - A plane through 3 points, a least-squares plane of all points, and its accumulator (after adding and removing outliers)
+bool CheckFit(PlaneEstimator& estimator, const Plane& truth)
+{
+    vector<int> inliers;
+    PlaneObserver observer;
+    Data data = observer.GenerateData(truth, 100, inliers, 0, 1);
+    Data outliers = observer.GenerateData(truth, 20, inliers, 0, 0);
+
+    bool success = true;
+    const int samples[] = { 0, 1, 2 };
+    Plane plane = estimator.ComputeModel(data, samples, 3);
+    if (!IsSame(plane, truth, 1e-9))
+    {
+        cout << "A plane through 3 points: " << plane << " != " << truth << endl;
+        success = false;
+    }
+    vector<int> all(data.size());
+    for (size_t i = 0; i < all.size(); i++) all[i] = static_cast<int>(i);
+    plane = estimator.ComputeModel(data, &all[0], static_cast<int>(all.size()));
+    if (!IsSame(plane, truth, 1e-9))
+    {
+        cout << "A least-squares plane: " << plane << " != " << truth << endl;
+        success = false;
+    }
+    RTL::Accumulator<Plane, Point3>* accumulator = estimator.CreateAccumulator();
+    for (size_t i = 0; i < data.size(); i++) accumulator->Add(data[i]);
+    for (size_t i = 0; i < outliers.size(); i++) accumulator->Add(outliers[i]);
+    for (size_t i = 0; i < outliers.size(); i++) accumulator->Remove(outliers[i]);
+    plane = accumulator->ComputeModel();
+    if (accumulator->GetCount() != static_cast<int>(data.size()) || !IsSame(plane, truth, 1e-6))
+    {
+        cout << "An accumulated plane: " << plane << " != " << truth << endl;
+        success = false;
+    }
+    delete accumulator;
+    return success;
+}
+
+// Check that errors of 'Point3Array' (vectorized if enabled) are same with errors of each point
+bool CheckErrors(const Plane& plane, const Data& data)
+{
+    PlaneEstimator estimator;
+    PlaneEstimatorT<Point3Array> arrayEstimator;
+    Point3Array array(data);
+    const int begin = 3, end = static_cast<int>(data.size()) - 2;
+    vector<double> errors(end - begin);
+    arrayEstimator.ComputeErrors(plane, array, begin, end, &errors[0]);
+    for (int i = begin; i < end; i++)
+    {
+        const double error = estimator.ComputeError(plane, data[i]);
+        if (fabs(errors[i - begin] - error) > 1e-9 * (fabs(error) + 1))
+        {
+            cout << "The error of point " << i << ": " << errors[i - begin] << " != " << error << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(void)
+{
+    const Plane truth(2. / 7, 3. / 7, 6. / 7, -50);
+    PlaneEstimator estimator;
+    bool success = CheckFit(estimator, truth);
+
+    // Find the plane among outliers
+    vector<int> inliers;
+    PlaneObserver observer;
+    Data data = observer.GenerateData(truth, 1000, inliers, 0.5, 0.5);
+    RTL::MSAC<Plane, Point3, Data> msac(&estimator);
+    msac.SetParamThreshold(2);
+    Plane plane;
+    msac.FindBest(plane, data, data.size(), 3);
+    if (!IsSame(plane, truth, 0.02))
+    {
+        cout << "MSAC: " << plane << " != " << truth << endl;
+        success = false;
+    }
+    success &= CheckErrors(plane, data);
+    return success ? 0 : 1;
+}
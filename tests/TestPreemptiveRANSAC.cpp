@@ -0,0 +1,47 @@
+#include "RTL.hpp"
+#include <cmath>
+#include <iostream>
+
+using namespace std;
+
+typedef vector<Point> Data;
+
+// Check that 'PreemptiveRANSAC' scores at most the given number of hypotheses
+// - If a block covers all data, it finds the same model as MSAC on the same hypotheses (the same seed).
+// - If the time budget is already spent, only the first hypothesis is generated.
+int main(void)
+{
+    vector<int> inliers;
+    LineObserver observer;
+    Data data = observer.GenerateData(Line(0.6, 0.8, -300), 1000, inliers, 1, 0.5);
+    LineEstimator estimator;
+    bool success = true;
+
+    RTL::PreemptiveRANSAC<Line, Point, Data> preemptive(&estimator);
+    RTL::MSAC<Line, Point, Data> msac(&estimator);
+    preemptive.SetParamThreshold(3);
+    preemptive.SetParamIteration(50);
+    preemptive.SetParamBlockSize(static_cast<int>(data.size()));
+    msac.SetParamThreshold(3);
+    msac.SetParamIteration(50);
+
+    Line model, reference;
+    double loss = preemptive.FindBest(model, data, data.size(), 2);
+    double referenceLoss = msac.FindBest(reference, data, data.size(), 2);
+    if (preemptive.GetIterationCount() != 50 || fabs(loss - referenceLoss) > 1e-9 * referenceLoss || model.a != reference.a || model.b != reference.b || model.c != reference.c)
+    {
+        cout << "PreemptiveRANSAC (Iterations: " << preemptive.GetIterationCount() << "): " << model << " (Loss: " << loss << ") != "
+             << reference << " (Loss: " << referenceLoss << ")" << endl;
+        success = false;
+    }
+
+    preemptive.SetParamBlockSize(100);
+    preemptive.SetParamTimeBudget(1e-9);
+    loss = preemptive.FindBest(model, data, data.size(), 2);
+    if (preemptive.GetIterationCount() != 1 || loss >= HUGE_VAL)
+    {
+        cout << "PreemptiveRANSAC with the time budget: " << preemptive.GetIterationCount() << " iterations (Loss: " << loss << ")" << endl;
+        success = false;
+    }
+    return success ? 0 : 1;
+}
@@ -0,0 +1,54 @@
+#include "RTL.hpp"
+#include <cmath>
+#include <iostream>
+
+using namespace std;
+
+// Check the decision threshold of SPRT with a value computed by hand
+// - epsilon = 0.1, delta = 0.01, and timeModel = 200 give
+//   C = 0.99 * log(0.99 / 0.9) + 0.01 * log(0.01 / 0.1) = 0.0713312,
+//   and A = 200 * C + 1 + log(A) = 18.1658 (by the fixed-point iteration).
+bool CheckThreshold(void)
+{
+    RTL::SPRT test(0.1, 0.01, 200);
+    const double expected = 18.1658;
+    if (fabs(test.GetThreshold() - expected) > 1e-3)
+    {
+        cout << "SPRT threshold: " << test.GetThreshold() << " (expected: " << expected << ")" << endl;
+        return false;
+    }
+    return true;
+}
+
+// Check that 'FindBest' still returns a model if SPRT rejects all hypotheses
+// - With a tiny threshold, only the samples are consistent with each hypothesis, so all of them are rejected.
+// - The returned loss should be the number of outliers of the returned model on all data.
+bool CheckAllRejected(void)
+{
+    vector<int> inliers;
+    LineObserver observer;
+    vector<Point> data = observer.GenerateData(Line(0.6, 0.8, -300), 1000, inliers, 1, 0.5);
+    LineEstimator estimator;
+    RTL::RANSAC<Line, Point, vector<Point> > ransac(&estimator);
+    ransac.SetParamThreshold(1e-9);
+    ransac.SetParamSPRT(true);
+
+    Line model;
+    double loss = ransac.FindBest(model, data, data.size(), 2);
+    int outlierNum = 0;
+    for (size_t i = 0; i < data.size(); i++)
+        if (fabs(estimator.ComputeError(model, data[i])) > 1e-9) outlierNum++;
+    if (loss >= HUGE_VAL || loss != outlierNum)
+    {
+        cout << "SPRT with all rejected: " << model << " (Loss: " << loss << ", Outliers: " << outlierNum << ")" << endl;
+        return false;
+    }
+    return true;
+}
+
+int main(void)
+{
+    bool success = CheckThreshold();
+    success &= CheckAllRejected();
+    return success ? 0 : 1;
+}
@@ -0,0 +1,64 @@
+#include "RTL.hpp"
+#include <cmath>
+#include <iostream>
+
+using namespace std;
+
+typedef vector<Point> Data;
+
+// Check that 'StaticRANSAC' with 'Loss' finds the same model and loss as the dynamic 'Algorithm' with the same seed
+// - 'FindBest' is called twice to check that the random stream is restarted.
+template <class Loss, class Algorithm>
+bool CheckLoss(const char* name, RTL::StaticRANSAC<LineEstimator, 2, Loss>& sransac, Algorithm& algorithm, const Data& data)
+{
+    Line model, smodel[2];
+    double loss = algorithm.FindBest(model, data, data.size(), 2);
+    for (int k = 0; k < 2; k++)
+    {
+        double sloss = sransac.FindBest(smodel[k], data, data.size());
+        const double tolerance = 1e-9 * (fabs(loss) + 1);
+        if (fabs(sloss - loss) > tolerance || fabs(smodel[k].a - model.a) > 1e-9 || fabs(smodel[k].b - model.b) > 1e-9 || fabs(smodel[k].c - model.c) > 1e-6)
+        {
+            cout << name << " (" << k + 1 << "): " << smodel[k] << " (Loss: " << sloss << ") != " << model << " (Loss: " << loss << ")" << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(void)
+{
+    vector<int> inliers;
+    LineObserver observer;
+    Data data = observer.GenerateData(Line(0.6, 0.8, -300), 1000, inliers, 1, 0.5);
+    LineEstimator estimator;
+    bool success = true;
+
+    RTL::StaticRANSAC<LineEstimator, 2, RTL::RANSACLoss> sransac(&estimator);
+    RTL::RANSAC<Line, Point, Data> ransac(&estimator);
+    sransac.SetParamThreshold(3);
+    ransac.SetParamThreshold(3);
+    success &= CheckLoss("RANSACLoss", sransac, ransac, data);
+
+    RTL::StaticRANSAC<LineEstimator, 2, RTL::MSACLoss> smsac(&estimator);
+    RTL::MSAC<Line, Point, Data> msac(&estimator);
+    smsac.SetParamThreshold(3);
+    msac.SetParamThreshold(3);
+    success &= CheckLoss("MSACLoss", smsac, msac, data);
+
+    RTL::StaticRANSAC<LineEstimator, 2, RTL::LMedSLoss> slmeds(&estimator);
+    RTL::LMedS<Line, Point, Data> lmeds(&estimator);
+    success &= CheckLoss("LMedSLoss", slmeds, lmeds, data);
+
+    // The parameters of the likelihood are not the defaults
+    RTL::StaticRANSAC<LineEstimator, 2, RTL::MLESACLoss> smlesac(&estimator);
+    RTL::MLESAC<Line, Point, Data> mlesac(&estimator);
+    smlesac.SetParamThreshold(3);
+    smlesac.GetLoss().SetParamSigmaScale(2.5);
+    smlesac.GetLoss().SetParamIterationEM(3);
+    mlesac.SetParamThreshold(3);
+    mlesac.SetParamSigmaScale(2.5);
+    mlesac.SetParamIterationEM(3);
+    success &= CheckLoss("MLESACLoss", smlesac, mlesac, data);
+    return success ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+#include "RTL.hpp"
+#include <cmath>
+#include <iostream>
+
+using namespace std;
+
+typedef vector<Point> Data;
+
+// StreamRANSAC which counts the support of its hypotheses again over the window
+class StreamRANSACReference : public RTL::StreamRANSAC<Line, Point, Data>
+{
+public:
+    StreamRANSACReference(RTL::Estimator<Line, Point, Data>* estimator, int capacity, int M) : RTL::StreamRANSAC<Line, Point, Data>(estimator, capacity, M) { }
+
+    // Check that the incremental support of each hypothesis is same with the number of its inliers in 'window'
+    bool CheckSupport(const Data& window)
+    {
+        for (size_t h = 0; h < dataHypotheses.size(); h++)
+        {
+            int support = 0;
+            for (size_t i = 0; i < window.size(); i++) support += IsInlier(dataHypotheses[h].model, window[i]);
+            if (support != dataHypotheses[h].support) return false;
+        }
+        return true;
+    }
+};
+
+// Check that 'StreamRANSAC' keeps the latest data in its window with their exact support
+// - Data come from a line, and then from another line, which the best model follows after a redraw.
+int main(void)
+{
+    const int CAPACITY = 200, N = 600;
+    vector<int> inliers;
+    LineObserver observer;
+    Data first = observer.GenerateData(Line(0.6, 0.8, -300), N, inliers, 1, 0.7);
+    Data second = observer.GenerateData(Line(0.8, -0.6, -100), N, inliers, 1, 0.7);
+    Data stream(first);
+    stream.insert(stream.end(), second.begin(), second.end());
+    LineEstimator estimator;
+    bool success = true;
+
+    StreamRANSACReference sransac(&estimator, CAPACITY, 2);
+    sransac.SetParamThreshold(3);
+    for (size_t i = 0; i < stream.size() && success; i++)
+    {
+        sransac.Push(stream[i]);
+        const int begin = static_cast<int>(i + 1) - CAPACITY;
+        Data window(stream.begin() + max(begin, 0), stream.begin() + i + 1);
+        if (sransac.GetSize() != static_cast<int>(window.size()) || !sransac.CheckSupport(window))
+        {
+            cout << "Push " << i << ": the window has " << sransac.GetSize() << " data (support: " << sransac.GetSupport() << ")" << endl;
+            success = false;
+        }
+    }
+
+    // The best model of the second line
+    Line model;
+    if (!sransac.GetBest(model) || sransac.GetRedrawCount() < 2 || fabs(model.a * 0.8 - model.b * 0.6) < 0.99)
+    {
+        cout << "The best model: " << model << " (Redraws: " << sransac.GetRedrawCount() << ")" << endl;
+        success = false;
+    }
+
+    // Eviction
+    for (int i = 0; i < CAPACITY / 2; i++) sransac.Evict();
+    Data window(stream.end() - CAPACITY / 2, stream.end());
+    if (sransac.GetSize() != CAPACITY / 2 || !sransac.CheckSupport(window))
+    {
+        cout << "Eviction: the window has " << sransac.GetSize() << " data (support: " << sransac.GetSupport() << ")" << endl;
+        success = false;
+    }
+    return success ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+#include "RTL.hpp"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+// Check that a failed trial of 'Sweep' is not recorded and is run again by resuming
+// - The first run fails at a trial, and the second run (resumed) runs only that trial.
+int main(void)
+{
+    const char* output = "TestSweep.csv";
+    remove(output);
+    remove((string(output) + ".progress").c_str());
+
+    const int CONFIG_NUM = 3, TRIAL_NUM = 4;
+    bool fail = true;
+    auto trialFunc = [&](int config, int trial, unsigned int seed, string& result) -> bool
+    {
+        if (fail && config == 1 && trial == 2) return false;
+        ostringstream record;
+        record << config << ", " << trial << ", " << seed << endl;
+        result = record.str();
+        return true;
+    };
+
+    bool success = true;
+    Sweep sweep;
+    sweep.SetParamThreadNum(2);
+    if (sweep.Run(output, CONFIG_NUM, TRIAL_NUM, trialFunc) || sweep.GetFailCount() != 1 || sweep.GetTrialCount() != CONFIG_NUM * TRIAL_NUM - 1)
+    {
+        cout << "First run: " << sweep.GetTrialCount() << " trials, " << sweep.GetFailCount() << " failed" << endl;
+        success = false;
+    }
+    fail = false;
+    if (!sweep.Run(output, CONFIG_NUM, TRIAL_NUM, trialFunc) || sweep.GetFailCount() != 0 || sweep.GetTrialCount() != 1)
+    {
+        cout << "Resumed run: " << sweep.GetTrialCount() << " trials, " << sweep.GetFailCount() << " failed" << endl;
+        success = false;
+    }
+
+    // Check that all trials are recorded once
+    ifstream file(output);
+    string line;
+    int count = 0, retried = 0;
+    while (getline(file, line))
+    {
+        int config = -1, trial = -1;
+        if (sscanf(line.c_str(), "%d, %d", &config, &trial) != 2) continue;
+        count++;
+        retried += (config == 1 && trial == 2);
+    }
+    if (count != CONFIG_NUM * TRIAL_NUM || retried != 1)
+    {
+        cout << "Recorded: " << count << " trials (the retried trial: " << retried << ")" << endl;
+        success = false;
+    }
+    file.close();
+    remove(output);
+    remove((string(output) + ".progress").c_str());
+    return success ? 0 : 1;
+}